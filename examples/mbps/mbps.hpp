@@ -35,6 +35,9 @@
 
 //if not using syncps defaults, set these here
 static constexpr size_t MAX_CONTENT=768; //max content size in bytes, <= maxPubSize in syncps.hpp
+// max content of a segment of a batch signed message. Leaves room for a 64
+// segment Merkle batch signature (196 bytes more than EdDSA's)
+static constexpr size_t MAX_BATCH_CONTENT=568;
 static constexpr size_t MAX_SEGS = 64;  //max segments of a msg, <= maxDifferences in syncps.hpp
 
 #include "dct/syncps/syncps.hpp"
@@ -63,9 +66,10 @@ using SegCnt = uint16_t;
 using Timer = ndn_ind::scheduler::ScopedEventId;
 using TimerCb = std::function<void()>;
 using MsgInfo = std::unordered_map<MsgID,std::bitset<64>>;
-using MsgSegs = std::vector<uint8_t>;
+using MsgSegs = std::vector<std::vector<uint8_t>>;
 using MsgCache = std::unordered_map<MsgID,MsgSegs>;
 using mbpsPub = DCTmodel::sPub;
+using mbpsPubView = DCTmodel::pubView;
 
 /*
  * Passes information about messages not in message body
@@ -95,8 +99,13 @@ struct mbps
     MsgInfo m_received{};  //received publications of a message
     MsgCache m_reassemble{}; //reassembly of received message segments
     Timer m_timer;
+    // pub name fields used on arrival & confirmation (resolved once)
+    DCTmodel::pubField m_sCnt, m_msgID, m_mts, m_target, m_topic, m_trgtLoc, m_topicArgs;
 
-    mbps(std::string_view bootstrap) : m_pb(bootstrap), m_pubpre{m_pb.pubPrefix()}  { }
+    mbps(std::string_view bootstrap) : m_pb(bootstrap), m_pubpre{m_pb.pubPrefix()},
+        m_sCnt{m_pb.fieldIndex("sCnt")}, m_msgID{m_pb.fieldIndex("msgID")}, m_mts{m_pb.fieldIndex("mts")},
+        m_target{m_pb.fieldIndex("target")}, m_topic{m_pb.fieldIndex("topic")},
+        m_trgtLoc{m_pb.fieldIndex("trgtLoc")}, m_topicArgs{m_pb.fieldIndex("topicArgs")} { }
 
     void run() { m_pb.run(); }
     const auto& pubPrefix() const noexcept { return m_pubpre; } //calling can convert to Name
@@ -191,44 +200,42 @@ struct mbps
      */
      void receivePub(const Publication& pub, const msgHndlr& mh)
      {      
-        const mbpsPub& p = mbpsPub(pub);
-        SegCnt k = p.number("sCnt"), n = 1u;
+        const mbpsPubView p(pub);
+        SegCnt k = p.number(m_sCnt), n = 1u;
         std::vector<uint8_t> msg;
         if (k == 0) { //single publication in this message
             if(auto sz = p.getContent().size())
                 msg.assign(p.getContent().buf(), p.getContent().buf() + sz);
         } else {
-            MsgID mId = p.number("msgID");
+            MsgID mId = p.number(m_msgID);
             n = 255 & k;    //bottom byte
             k >>= 8;
             if (k > n || k == 0 || n > MAX_SEGS) {
-                _LOG_WARN("receivePub: msgID " << p.number("msgID") << " piece " << k << " > " << n << " pieces");
+                _LOG_WARN("receivePub: msgID " << p.number(m_msgID) << " piece " << k << " > " << n << " pieces");
                 return;
             }
-            //reassemble message            
+            //reassemble message. Segments are held separately since their size
+            //depends on how the sender signed them (see publish)
             const auto& m = *p.getContent();
-            auto& dst = m_reassemble[mId];
-            if (k == n)
-                dst.resize((n-1)*MAX_CONTENT+m.size());
-            else if (dst.size() == 0)
-                dst.resize(n*MAX_CONTENT);
-            std::copy(m.begin(), m.end(), dst.begin()+(--k)*MAX_CONTENT);
+            auto& segs = m_reassemble[mId];
+            if (segs.size() < n) segs.resize(n);
+            segs[--k].assign(m.begin(), m.end());
             m_received[mId].set(k);
             if (m_received[mId].count() != n) return; // all segments haven't arrived
-            msg = m_reassemble[mId];
+            for (const auto& s : segs) msg.insert(msg.end(), s.begin(), s.end());
             m_received.erase(mId);  //delete msg state
             m_reassemble.erase(mId);
         }                
         /*
          * Complete message received, prepare arguments for msgHndlr callback
          */
-        _LOG_INFO("receivePiece: msgID " << p.number("msgID") << "(" << n << " pieces) delivered in " << p.timeDelta("mts") << " sec.");
+        _LOG_INFO("receivePiece: msgID " << p.number(m_msgID) << "(" << n << " pieces) delivered in " << p.timeDelta(m_mts) << " sec.");
         msgArgs ma;
-        ma.ts =  p.time("mts");
-        ma.cap = p["target"];
-        ma.topic = p["topic"];
-        ma.loc = p["trgtLoc"];
-        ma.args = p["topicArgs"];
+        ma.ts =  p.time(m_mts);
+        ma.cap = p[m_target];
+        ma.topic = p[m_topic];
+        ma.loc = p[m_trgtLoc];
+        ma.args = p[m_topicArgs];
         mh(*this, msg, ma);
     }
 
@@ -248,9 +255,9 @@ struct mbps
      */
     void confirmPublication(const Publication& pub, bool success)
     {
-        const mbpsPub& p = mbpsPub(pub);
-        MsgID mId = p.number("msgID");
-        SegCnt k = p.number("sCnt"), n = 1u;
+        const mbpsPubView p(pub);
+        MsgID mId = p.number(m_msgID);
+        SegCnt k = p.number(m_sCnt), n = 1u;
         if (k != 0) {
             // Don't need to keep state for single piece msgs but multi-piece succeed
             // only if all their pieces arrive and fail otherwise. Keep per-msg arrival
@@ -265,7 +272,7 @@ struct mbps
             if (m_pending.contains(mId)) m_pending.erase(mId);
         }
         if (success) {  //TTP = "time to publish"
-            _LOG_INFO("confirmPublication: msgID " << mId << "(" << n << " pieces) arrived, TTP " << p.timeDelta("mts"));
+            _LOG_INFO("confirmPublication: msgID " << mId << "(" << n << " pieces) arrived, TTP " << p.timeDelta(m_mts));
             //if a confirmation cb set by app, would go here
         } else {
             _LOG_INFO("confirmPublication: msgID " << mId << " " << n - k << " pieces (of " << n << ") timed out");
@@ -322,24 +329,45 @@ struct mbps
         uint32_t mId = h[0] | h[1] << 8 | h[2] << 16 | h[3] << 24;
 
         // determine number of message segments: sCnt forces n < 256,
-        // iblt is sized for 80 but 64 fits in an int bitset
+        // iblt is sized for 80 but 64 fits in an int bitset.
+        // Multi-segment messages are batch signed if the pub sigmgr can and the
+        // smaller segments that needs still fit in MAX_SEGS.
         size_t n = (size + (MAX_CONTENT - 1)) / MAX_CONTENT;
         if(n > MAX_SEGS) throw error("publishMsg: message too large");
+        const bool batch = n > 1 && m_pb.pubSigMgr().batchSigning()
+                           && (size + (MAX_BATCH_CONTENT - 1)) / MAX_BATCH_CONTENT <= MAX_SEGS;
+        if (batch) n = (size + (MAX_BATCH_CONTENT - 1)) / MAX_BATCH_CONTENT;
         auto sCnt = n > 1? n + 256 : 0;
-        for (auto off = 0u; off < size; off += MAX_CONTENT) {
-            auto len = std::min(size - off, MAX_CONTENT);
-            if(ch) {
-                m_pb.publish(m_pb.pub(msg.subspan(off, len), "target",
-                        a.cap, "trgtLoc", a.loc, "topic", a.topic,
-                        "topicArgs", a.args, "msgID", mId, "sCnt", sCnt,
-                        "mts", mts), [this](auto p, bool s) {
-                            confirmPublication(mbpsPub(p),s); });
-            } else {
-                m_pb.publish(m_pb.pub(msg.subspan(off, len), "target", a.cap,
-                            "trgtLoc", a.loc, "topic", a.topic, "topicArgs", a.args,
-                            "msgID", mId, "sCnt", sCnt, "mts", mts));
+        // segment names differ only in sCnt so the name is prepared once
+        auto pn = m_pb.prepare({"sCnt"}, "target", a.cap, "trgtLoc", a.loc, "topic", a.topic,
+                               "topicArgs", a.args, "msgID", mId, "sCnt", sCnt, "mts", mts);
+        if (batch) {
+            // all the segments are covered by one (Merkle batch) signature
+            std::vector<syncps::Publication> segs{};
+            segs.reserve(n);
+            for (auto off = 0u; off < size; off += MAX_BATCH_CONTENT, sCnt += 256) {
+                auto len = std::min(size - off, MAX_BATCH_CONTENT);
+                segs.emplace_back(m_pb.unsignedPub(msg.subspan(off, len), pn.set("sCnt", sCnt)));
+            }
+            if (! m_pb.signBatch(segs)) throw error("publishMsg: batch signing failed");
+            for (auto& seg : segs) {
+                if(ch) m_pb.publish(std::move(seg), [this](auto p, bool s) { confirmPublication(p,s); });
+                else m_pb.publish(std::move(seg));
+            }
+        } else if (n == 1) {
+            // a single pub is signed & published directly (no worker handoff)
+            if(ch) m_pb.publish(m_pb.pub(msg, pn), [this](auto p, bool s) { confirmPublication(p,s); });
+            else m_pb.publish(m_pb.pub(msg, pn));
+        } else {
+            // segments are named & signed in parallel on the model's worker pool
+            // (they're still published in order)
+            for (auto off = 0u; off < size; off += MAX_CONTENT, sCnt += 256) {
+                auto len = std::min(size - off, MAX_CONTENT);
+                pn.set("sCnt", sCnt);
+                if(ch) m_pb.publishAsync([this](auto p, bool s) { confirmPublication(p,s); },
+                                         msg.subspan(off, len), pn);
+                else m_pb.publishAsync(msg.subspan(off, len), pn);
             }
-            sCnt += 256;    //segment names differ only in sCnt
         }
         if(ch) {
             _LOG_INFO("mbps has published (with call back) mId: " << mId);
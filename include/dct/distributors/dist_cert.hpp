@@ -81,7 +81,7 @@ struct DistCert
                     return pOurs;
                 });
 #endif
-        m_sync.subscribeTo(m_pubPrefix, [this](auto p) {onReceiveCert(reinterpret_cast<const dctCert&>(p));});
+        m_sync.subscribeTo(m_pubPrefix, [this](auto p) {onReceiveCert(dctCert(std::move(p)));});
     }
 
     /*
@@ -114,6 +114,21 @@ struct DistCert
     void publishCert(certPub&& c) { m_sync.publish(std::move(c)); }
     void publishCert(const certPub& c) { publishCert(certPub(c)); }
 
+    /*
+     * Called when the parent had to drop a cert it received from a peer
+     * without adding it to its certstore (e.g., it was evicted while waiting
+     * for its signing cert). Cert pubs don't expire and are delivered once so
+     * the cert is forgotten in order to get it from a peer again.
+     * (SVS doesn't support refetching so the cert stays lost.)
+     */
+    void refetch(const certPub& c) {
+#ifndef SYNCPS_IS_SVS
+        if (m_sync.forget(c)) _LOG_INFO("refetch " << c.getName().toUri());
+#else
+        (void) c;
+#endif
+    }
+
     void initialPub(certPub&& c) {
         _LOG_INFO("initialPub " << c.getName());
         if (! m_havePeer) {
@@ -9,7 +9,9 @@
  * group key. Only one entity should be making group keys and will rekey at periodic intervals to
  * distribute a new key, encrypting each key with the public key of each peer.
  * (see  https://libsodium.gitbook.io/doc/advanced/ed25519-curve25519)
- * If a new membercomes up between rekeying, it is added to the list of encrypted keys which is republished.
+ * If a new member comes up between rekeying, its encrypted key is published in a 'delta' Publication
+ * that carries only the records of members added since the last (re)key. The full list of encrypted
+ * keys is only republished when the key changes.
  * The group key can be used by sigmgr_aead.hpp
  *
  * Copyright (C) 2020-1 Pollere, Inc.
@@ -42,7 +44,11 @@
 #include "dct/syncps/syncps.hpp"
 #include "dct/utility.hpp"
 
+// group keys are used by SigMgrAEAD for both ChaCha20-Poly1305 (AEAD) and AES-256-GCM (AEADGCM)
+// and by SigMgrMAC as a keyed BLAKE2b key
 const uint32_t aeadKeySz = crypto_aead_chacha20poly1305_IETF_KEYBYTES;
+static_assert(aeadKeySz == crypto_aead_aes256gcm_KEYBYTES && aeadKeySz == crypto_generichash_KEYBYTES,
+              "group key must suit all group key sigmgrs");
 static constexpr size_t encGKeySz = crypto_box_SEALBYTES + aeadKeySz;
 using encGK = std::array<uint8_t, crypto_box_SEALBYTES + aeadKeySz>;
 using keyVal = std::vector<uint8_t>;
@@ -57,6 +63,12 @@ using Timer = ndn_ind::scheduler::ScopedEventId;
  * pairs containing that symmetric key individually encrypted for each peer. Each
  * pair has the thumbprint of a signing key and the symmetric key encrypted using that
  * (public) signing key. (12 bytes also accounts for tlv indicators)
+ *
+ * The dCnt name component of a full list's Publications has the Publication's number
+ * in its upper 8 bits and the number of Publications in its lower 8 bits (0 if the list
+ * fits in one). Delta Publications have 0 in the lower 8 bits and a non-zero number in
+ * the upper 8. Members don't need to distinguish these since both have the same content
+ * format and a member just looks for the record with its thumbprint.
  */
 using gkr = std::pair <thumbPrint, encGK>;
 
@@ -77,12 +89,17 @@ struct DistGKey
     connectedCb m_connCb{[](auto) {}};
     log4cxx::LoggerPtr staticModuleLogger{log4cxx::Logger::getLogger("DistGKey")};
     Timer m_timer{};
+    Timer m_deltaTimer{};
     thumbPrint m_tp{};
     keyVal m_pDecKey{};         //transformed pk used to encrypt group key
     keyVal m_sDecKey{};         //transformed sk used to decrypt group key
     keyVal m_curKey{};          //current group key
     uint64_t m_curKeyCT{};      //current key creation time in microsecs
     std::map<thumbPrint,encGK> m_gkrList{};
+    std::vector<thumbPrint> m_delta{};  //members added since last key list or delta was published
+    std::chrono::milliseconds m_deltaDly{50};   //time to collect new members into one delta
+    pubCnt m_deltaCnt{};        //delta Publications published for current key
+    bool m_deltaSched{false};   //publishDelta is scheduled
     std::chrono::milliseconds m_reKeyInt{};
     std::chrono::milliseconds m_keyRand{};
     std::chrono::milliseconds m_keyLifetime{};
@@ -108,6 +125,10 @@ struct DistGKey
             (void) expirationGB;
 #ifndef SYNCPS_IS_SVS
             m_sync.pubLifetime(std::chrono::milliseconds(reKeyInterval + reKeyRandomize + expirationGB));
+            // rate limit key list validation failures by the (EdDSA authenticated) sender of the sync Data
+            m_sync.pubSourceCb([](const ndn_ind::Data& d, const syncps::Publication&) -> uint64_t {
+                        try { return std::hash<thumbPrint>{}(dctCert::getKeyLoc(d)); }
+                        catch (const std::exception&) { return 0; } });
             m_sync.isExpiredCb([this](auto p) {
                 if(p.getName()[-1].toTimestampMicroseconds() < m_curKeyCT) {
                     _LOG_DEBUG("DistGKey received expired Publication");
@@ -212,10 +233,7 @@ struct DistGKey
                 std::vector<gkr> gkrSet;    // holds one Publication's content
                 for(size_t j=0; j < r; ++j, ++it)
                     gkrSet.push_back({it->first, it->second});
-                tlvEncoder gkrEnc{};    //tlv encoded content
-                gkrEnc.addNumber(36, m_curKeyCT);
-                gkrEnc.addArray(130, gkrSet);    //says Array but it's okay with vector
-                addToCollection(dCnt, pubTS, gkrEnc.vec());
+                addToCollection(dCnt, pubTS, encodeGKRs(gkrSet));
                 dCnt += 256;   // increment the publication# part of dCnt
             } catch (const std::runtime_error& e) {
                 std::cerr << "publishKeyList encountered exception: " << e.what() << std::endl;e.what();
@@ -224,6 +242,48 @@ struct DistGKey
         }
     }
 
+    /*
+     * Used by the keyMaker
+     * Publish the key records of members added since the current key was made or the
+     * last delta was published. Collecting members for m_deltaDly means a burst of new
+     * members (e.g., at startup) results in full Publications rather than one per member.
+     * A new member's record is in its delta Publication(s) and in every full key list
+     * published after it joined so there's no need to republish existing members' records.
+     */
+    void publishDelta()
+    {
+        m_deltaSched = false;
+        if(m_delta.empty()) return;   //members were removed
+
+        auto pubTS = std::chrono::system_clock::now();
+        std::sort(m_delta.begin(), m_delta.end());
+        for(size_t i = 0; i < m_delta.size(); ) {
+            std::vector<gkr> gkrSet;    // holds one Publication's content
+            for(; i < m_delta.size() && gkrSet.size() < max_gkRs; ++i) {
+                if(auto it = m_gkrList.find(m_delta[i]); it != m_gkrList.end())
+                    gkrSet.push_back({it->first, it->second});
+            }
+            if(gkrSet.empty()) continue;
+            if(++m_deltaCnt > 255) m_deltaCnt = 1;  //only needs to be non-zero
+            _LOG_INFO("publishDelta publishes " << gkrSet.size() << " key records");
+            try {
+                addToCollection(pubCnt(m_deltaCnt << 8), pubTS, encodeGKRs(gkrSet));
+            } catch (const std::runtime_error& e) {
+                std::cerr << "publishDelta encountered exception: " << e.what() << std::endl;
+            }
+        }
+        m_delta.clear();
+    }
+
+    // tlv encode the current key's creation time and a set of key records as Publication content
+    std::vector<uint8_t> encodeGKRs(const std::vector<gkr>& gkrSet)
+    {
+        tlvEncoder gkrEnc{};    //tlv encoded content
+        gkrEnc.addNumber(36, m_curKeyCT);
+        gkrEnc.addArray(130, gkrSet);    //says Array but it's okay with vector
+        return gkrEnc.vec();
+    }
+
     /*
      * Use passed in component values and content to create Publication and add
      * to the group key list collection
@@ -267,8 +327,8 @@ struct DistGKey
     void makeGKey()
     {
         //make a new key
-        m_curKey.resize(aeadKeySz); // crypto_aead_chacha20poly1305_IETF_KEYBYTES
-        crypto_aead_chacha20poly1305_ietf_keygen(m_curKey.data());
+        m_curKey.resize(aeadKeySz); // uniformly random key valid for any group key sigmgr
+        randombytes_buf(m_curKey.data(), m_curKey.size());
         //set the key's creation time
         m_curKeyCT = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
         _LOG_INFO("makeGKey makes " << m_curKey.size() << " byte key with time " << m_curKeyCT);
@@ -279,6 +339,10 @@ struct DistGKey
             auto c = m_certs[it->first];
             it->second = encryptGKey(c.getContent()->data());
         }
+        m_deltaTimer.cancel();  //the full list has all members
+        m_deltaSched = false;
+        m_delta.clear();
+        m_deltaCnt = 0;
         publishKeyList();
         _LOG_INFO("makeGKey reschedules makeGKey");
         m_timer = m_sync.schedule(m_reKeyInt, [this](){ makeGKey();});  //next re-keying event
@@ -307,15 +371,22 @@ struct DistGKey
             _LOG_INFO("addGroupMem can't add this peer as exceeds maximum");
             return;
         }
-        //create new gkr for this peer and add to m_gkrList
+        //create new gkr for this peer, add to m_gkrList and publish it in the next delta
         _LOG_INFO("addGroupMem gets cert " << c.getName().toUri());
-        m_gkrList[c.computeThumbPrint()] = encryptGKey(c.getContent()->data());
-        publishKeyList();    //publish the updated m_gkrList
+        auto tp = c.computeThumbPrint();
+        if(m_gkrList.contains(tp)) return;  //already has the current key
+        m_gkrList[tp] = encryptGKey(c.getContent()->data());
+        m_delta.push_back(tp);
+        if(!m_deltaSched) {
+            m_deltaSched = true;
+            m_deltaTimer = m_sync.schedule(m_deltaDly, [this](){ publishDelta(); });
+        }
     }
 
     // won't encrypt a group key for this thumbPrint in future
     void removeGroupMem(thumbPrint& tp) {
            m_gkrList.erase(tp);
+           std::erase(m_delta, tp);
            return;
        }
 
@@ -0,0 +1,138 @@
+#ifndef REJECT_CACHE_HPP
+#define REJECT_CACHE_HPP
+/*
+ * Negative cache and failure rate limiter for objects that fail validation
+ *
+ * Copyright (C) 2021 Pollere, Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, see <https://www.gnu.org/licenses/>.
+ *  You may contact Pollere, Inc at info@pollere.net.
+ *
+ *  The DCT proof-of-concept is not intended as production code.
+ *  More information on DCT is available from info@pollere.net
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+// Hashes of the wire encodings of objects (pubs or certs) that failed
+// validation. Peers re-send objects we don't have so, without this, each copy
+// of the same bad object costs a full decode and signature check. At most
+// 'maxEntries' hashes are held, each for at most 'ttl' (oldest go first).
+struct rejectCache {
+    using clock = std::chrono::steady_clock;
+
+    size_t maxEntries_;
+    clock::duration ttl_;
+    std::deque<std::pair<uint64_t,clock::time_point>> order_{}; // in insertion order
+    std::unordered_set<uint64_t> hashes_{};
+    size_t hits_{};
+
+    rejectCache(size_t maxEntries = 1024, clock::duration ttl = std::chrono::seconds(60)) :
+        maxEntries_{maxEntries}, ttl_{ttl} { }
+
+    auto size() const noexcept { return hashes_.size(); }
+    auto hits() const noexcept { return hits_; }
+
+    bool contains(uint64_t h, clock::time_point now = clock::now()) {
+        expire(now);
+        if (! hashes_.contains(h)) return false;
+        ++hits_;
+        return true;
+    }
+
+    void add(uint64_t h, clock::time_point now = clock::now()) {
+        if (maxEntries_ == 0 || ! hashes_.emplace(h).second) return;
+        order_.emplace_back(h, now);
+        if (order_.size() > maxEntries_) pop();
+    }
+
+    void expire(clock::time_point now = clock::now()) {
+        while (! order_.empty() && now - order_.front().second > ttl_) pop();
+    }
+
+    void pop() {
+        hashes_.erase(order_.front().first);
+        order_.pop_front();
+    }
+};
+
+// Per-source validation failure counts. A source (a signer or name prefix,
+// identified by a hash) with more than 'maxFails' failures in 'window' is
+// shed for 'holdoff': the caller skips validating its objects (without
+// caching them as bad so good ones are accepted when they're re-sent after
+// the holdoff). This bounds the crypto a flood of distinct bad objects can
+// cost. At most 'maxSources' sources are tracked.
+struct failLimiter {
+    using clock = std::chrono::steady_clock;
+    struct source {
+        clock::time_point start{};      // start of current counting window
+        clock::time_point shedUntil{};
+        uint32_t fails{};
+    };
+
+    size_t maxSources_;
+    uint32_t maxFails_;
+    clock::duration window_;
+    clock::duration holdoff_;
+    std::unordered_map<uint64_t,source> src_{};
+    size_t shed_{};                     // objects skipped due to a holdoff
+
+    failLimiter(uint32_t maxFails = 32, clock::duration window = std::chrono::seconds(1),
+                clock::duration holdoff = std::chrono::seconds(1), size_t maxSources = 1024) :
+        maxSources_{std::max(maxSources, size_t(1))}, maxFails_{maxFails}, window_{window}, holdoff_{holdoff} { }
+
+    auto shed() const noexcept { return shed_; }
+
+    // true if objects from source 'k' should be skipped
+    bool shedding(uint64_t k, clock::time_point now = clock::now()) {
+        const auto s = src_.find(k);
+        if (s == src_.end() || now >= s->second.shedUntil) return false;
+        ++shed_;
+        return true;
+    }
+
+    // note a validation failure of an object from source 'k'
+    void fail(uint64_t k, clock::time_point now = clock::now()) {
+        if (src_.size() >= maxSources_ && ! src_.contains(k)) prune(now);
+        auto& s = src_[k];
+        if (now - s.start > window_) {
+            s.start = now;
+            s.fails = 0;
+        }
+        if (++s.fails > maxFails_) {
+            s.shedUntil = now + holdoff_;
+            s.start = now;
+            s.fails = 0;
+        }
+    }
+
+    // forget sources that aren't being shed and whose window has passed. If
+    // that doesn't make room, forget all those not being shed (or, if all are
+    // being shed, an arbitrary one).
+    void prune(clock::time_point now) {
+        std::erase_if(src_, [this, now](const auto& s) {
+                                return now >= s.second.shedUntil && now - s.second.start > window_; });
+        if (src_.size() < maxSources_) return;
+        std::erase_if(src_, [now](const auto& s) { return now >= s.second.shedUntil; });
+        if (src_.size() >= maxSources_) src_.erase(src_.begin());
+    }
+};
+
+#endif // REJECT_CACHE_HPP
@@ -24,8 +24,13 @@
  *  More information on DCT is available from info@pollere.net
  */
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <memory>
 #include <type_traits>
 #include <sstream>
 #include <stdexcept>
@@ -136,9 +141,108 @@ static inline const std::map<sTLV,const char*> tlvName{
     {sTLV::pub, "pub"}
 };
 
+// Map from token string to a small value (token number, component index).
+// These maps are built once when a schema or pub template is loaded then
+// consulted for every pub built or validated so they're a compact open
+// addressing table rather than a node-based hash map: 'slots_' is a power
+// of two sized array of (1 + index) into 'ent_' (0 = empty) kept at most
+// half full so linear probes are short. Keys are views so the strings they
+// refer to must outlive the map (they're normally in a schema's stab_).
+// The interface is the subset of unordered_map the schema code uses.
+template<typename V>
+struct tokMap {
+    struct entry { bTok first; V second; };
+    std::vector<entry> ent_{};
+    std::vector<uint16_t> slots_{};
+
+    // FNV-1a (tokens are short so this beats more elaborate hashes)
+    static constexpr size_t hash(bTok s) noexcept {
+        uint32_t h = 2166136261u;
+        for (auto c : s) h = (h ^ uint8_t(c)) * 16777619u;
+        return h;
+    }
+    const entry* end() const noexcept { return nullptr; }
+    const entry* find(bTok key) const noexcept {
+        if (slots_.empty()) return end();
+        const size_t mask = slots_.size() - 1;
+        for (auto i = hash(key) & mask; slots_[i] != 0; i = (i + 1) & mask) {
+            if (const auto& e = ent_[slots_[i] - 1]; e.first == key) return &e;
+        }
+        return end();
+    }
+    bool contains(bTok key) const noexcept { return find(key) != end(); }
+    auto size() const noexcept { return ent_.size(); }
+    bool empty() const noexcept { return ent_.empty(); }
+    void clear() noexcept { ent_.clear(); slots_.clear(); }
+
+    void reserve(size_t n) {
+        size_t ns = 8;
+        while (ns < n * 2) ns <<= 1;
+        if (ns <= slots_.size()) return;
+        slots_.assign(ns, 0);
+        ent_.reserve(n);
+        for (size_t i = 0; i < ent_.size(); ++i) place(ent_[i].first, i);
+    }
+    // add key->val if key isn't already present (like unordered_map::emplace)
+    bool emplace(bTok key, V val) {
+        if (contains(key)) return false;
+        if (ent_.size() >= std::numeric_limits<uint16_t>::max() - 1) throw schema_error("token map full");
+        if ((ent_.size() + 1) * 2 > slots_.size()) reserve(std::max(ent_.size() * 2, size_t(4)));
+        ent_.emplace_back(entry{key, val});
+        place(key, ent_.size() - 1);
+        return true;
+    }
+  private:
+    void place(bTok key, size_t idx) noexcept {
+        const size_t mask = slots_.size() - 1;
+        auto i = hash(key) & mask;
+        while (slots_[i] != 0) i = (i + 1) & mask;
+        slots_[i] = idx + 1;
+    }
+};
+
+// Read-only view of a packed array of fixed-size schema items (e.g., the
+// discrims or pubs) in the schema's buffer. The buffer has no alignment
+// guarantees so items are copied out on access.
+template<typename T>
+struct itemView {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const uint8_t* data_{};
+    size_t size_{};
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = T;
+
+        const uint8_t* p_{};
+        T operator*() const noexcept { T t; std::memcpy(&t, p_, sizeof(T)); return t; }
+        iterator& operator++() noexcept { p_ += sizeof(T); return *this; }
+        iterator operator++(int) noexcept { auto i = *this; p_ += sizeof(T); return i; }
+        bool operator==(const iterator&) const = default;
+    };
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    T operator[](size_t i) const noexcept { return *iterator{data_ + i * sizeof(T)}; }
+    T at(size_t i) const {
+        if (i >= size_) throw std::out_of_range("schema item index out of range");
+        return (*this)[i];
+    }
+    iterator begin() const noexcept { return {data_}; }
+    iterator end() const noexcept { return {data_ + size_ * sizeof(T)}; }
+};
+
+// A bSchema's string table, tokens, discrims and pubs are views into the
+// binary schema so it holds a (shared) reference to it. The schema is
+// immutable so copies share the buffer and no fixups are needed.
 struct bSchema {
+    using schemaBuf = std::shared_ptr<const std::vector<uint8_t>>;
 
-    std::string stab_{};
+    schemaBuf buf_{};
+    std::string_view stab_{};
     std::vector<bTok> tok_{};
     std::vector<bName> cert_{};
     std::vector<bChain> chain_{};
@@ -146,9 +250,9 @@ struct bSchema {
     std::vector<bName> tag_{};
     std::vector<bName> tmplt_{};
     std::vector<bName> vlist_{};
-    std::vector<tDiscrim> discrim_{};
-    std::vector<tPub> pub_{};
-    std::unordered_map<bTok,bComp> tm_{};
+    itemView<tDiscrim> discrim_{};
+    itemView<tPub> pub_{};
+    tokMap<bComp> tm_{};
 
     // return the name of the pub at index 'i'
     bTok pubName(pubidx i) const {
@@ -181,35 +285,6 @@ struct bSchema {
     }
     // return the value of a pub's first template as a string
     std::string pubVal(bTok nm) const { return bNameToStr(pubTmpl0(findPub(nm))); }
-
-    // tokens are string_views so their addresses have to be fixed when copying another schema
-    void _fixup_tok(const bSchema& other) {
-        stab_ = other.stab_;
-        tok_ = other.tok_;
-        cert_ = other.cert_;
-        chain_ = other.chain_;
-        cor_ = other.cor_;
-        tag_ = other.tag_;
-        tmplt_ = other.tmplt_;
-        vlist_ = other.vlist_;
-        discrim_ = other.discrim_;
-        pub_ = other.pub_;
-        tm_.clear();
-        auto off = stab_.data() - other.stab_.data();
-        for (size_t i = 0, n = tok_.size(); i < n; i++) {
-            auto& otok = other.tok_[i];
-            tok_[i] = bTok(otok.data() + off, otok.size());
-            tm_.emplace(tok_[i], i);
-        }
-    }
-    bSchema() = default;
-
-    bSchema(const bSchema& other) { _fixup_tok(other); }
-
-    bSchema& operator=(const bSchema& other) {
-        if (this != &other) { _fixup_tok(other); }
-        return *this;
-    }
 };
 
 } //namespace bschema
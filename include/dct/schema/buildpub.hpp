@@ -27,12 +27,15 @@
 #include <array>
 #include <bitset>
 #include <chrono>
+#include <deque>
+#include <initializer_list>
 #include <set>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 #include "certstore.hpp"
 #include "dct/format.hpp"
 #include "dct/utility.hpp"
@@ -66,6 +69,50 @@ struct fmt::formatter<ndn_ind::Name::Component>: fmt::dynamic_formatter<> {
     }
 };
 
+// convert a parameter value to the name component that carries it
+static inline ndn_ind::Name::Component paramComp(const paramVal& v) {
+    using Comp = ndn_ind::Name::Component;
+    return std::visit(overloaded {
+                [](std::monostate) { return Comp("(empty)"s); },
+                [](std::string_view val) { return Comp(std::string(val)); },
+                [](const std::string& val) { return Comp(val); },
+                [](timeVal val) { return Comp::fromTimestamp(val); },
+                [](uint64_t val) { return Comp::fromNumber(val); },
+            }, v);
+}
+
+// A pub name prepared for repeated use (see pubBldr::prepare). The pub
+// template was resolved and all the name's components constructed once so
+// each name() just copies the components (which share their values) and
+// replaces the ones that change: params listed as variable at prepare time
+// (updated via set()) and 'timestamp()' calls (re-evaluated for each name).
+struct preparedName {
+    using Comp = ndn_ind::Name::Component;
+
+    std::vector<Comp> comps_{};                     // components with prepared values
+    std::vector<std::pair<bTok,compidx>> vary_{};   // variable param tag & its component
+    std::vector<compidx> now_{};                    // components that are timestamp() calls
+
+    // set the value of variable param 'tag' for subsequent names
+    preparedName& set(std::string_view tag, const paramVal& val) {
+        bool found{false};
+        for (const auto& [t, c] : vary_) {
+            if (t != tag) continue;
+            comps_[c] = paramComp(val);
+            found = true;
+        }
+        if (! found) throw schema_error(format("param {} wasn't prepared as variable", tag));
+        return *this;
+    }
+
+    ndn_ind::Name name() const {
+        if (now_.empty()) return ndn_ind::Name(comps_);
+        auto comps = comps_;
+        const auto ts = Comp::fromTimestamp(std::chrono::system_clock::now());
+        for (auto c : now_) comps[c] = ts;
+        return ndn_ind::Name(comps);
+    }
+};
 
 // template describing one viable pub for some particular signing chain.
 // An array of such templates is the primary structure used by both the
@@ -81,7 +128,10 @@ struct pTmplt {
 template<bool pbdebug = false>
 struct pubBldr {
     // make a 'builder' for pub 'pub' of binary schema 'bs' using certificate store 'cs'.
-    pubBldr(const bSchema& bs, certStore& cs, bTok pub) : bs_{bs}, cs_{cs} {
+    // Templates are built for signing chain 'chain' (a signing cert and its signers)
+    // or, if it's empty, for the certstore's signing chain.
+    pubBldr(const bSchema& bs, certStore& cs, bTok pub, chainRefs chain = {}) :
+            bs_{bs}, cs_{cs}, chain_{chain.empty()? cs.signingChain() : std::move(chain)} {
         pidx_ = bs_.findPub(pub);
         if (pidx_ < 0) throw schema_error(format("pub {} not found", pub));
         makePubTmplts(findCerts());
@@ -91,10 +141,9 @@ struct pubBldr {
     static inline void dprint(fmt::format_string<T...> format_str, T&&... args) {
         if constexpr (pbdebug) print(format_str, std::forward<T>(args)...);
     }
-    struct tagMap : std::unordered_map<bTok,compidx> {
-        using std::unordered_map<bTok,compidx>::unordered_map;
+    struct tagMap : tokMap<compidx> {
         compidx operator[](bTok key) const {
-            if (const auto& v = find(key); v != end()) return v->second;
+            if (const auto v = find(key); v != end()) return v->second;
             throw schema_error(format("no {} parameter for pub", key));
         }
     };
@@ -121,40 +170,87 @@ struct pubBldr {
         }
         return res;
     }
-    bool matches(const certName& cert, const bName& bcert) const {
+    static bool matches(const bSchema& bs, const certName& cert, const bName& bcert) {
        if (cert.size() != bcert.size()) return false;
-       auto ntok = bs_.tok_.size();
+       auto ntok = bs.tok_.size();
        for (auto n = cert.size(), i=0ul; i < n; i++) {
-           if (bcert[i] < ntok && cert[i].getValue().toRawStr() != bs_.tok_[bcert[i]]) return false;
+           if (bcert[i] < ntok && cert[i].getValue().toRawStr() != bs.tok_[bcert[i]]) return false;
        }
        return true;
     }
-    bool matches(const certVec& chain, const bChain& bchain) const {
+    static bool matches(const bSchema& bs, const chainRefs& chain, const bChain& bchain) {
        if (chain.size() != bchain.size()) return false;
-       for (auto n = chain.size(), i=0ul; i < n; i++) if (! matches(chain[i], bs_.cert_[bchain[i]])) return false;
+       for (auto n = chain.size(), i=0ul; i < n; i++) if (! matches(bs, chain[i]->getName(), bs.cert_[bchain[i]])) return false;
        return true;
     }
-    // find the first signing chain in the certStore consistent with the
-    // schema and use it to initialize the 'cert_' array.
-    auto findCerts() {
-        // candidate chains are 'or' of this pub's cor chain bitmaps
-        const auto& [param,disc,pub,tagi] = bs_.pub_[pidx_];
+    // candidate chains of pub 'pidx' are the 'or' of its cor chain bitmaps
+    static chainBM pubChains(const bSchema& bs, int pidx) {
+        const auto& [param,disc,pub,tagi] = bs.pub_[pidx];
         discSet ds{disc};
-        for (size_t d = 0, de = bs_.discrim_.size(); d < de; d++) if (ds[d]) cbm_ |= bs_.discrim_[d].cbm;
-        if (cbm_ == 0) {
-            dprint("chain: not needed\n");
-            return cbm_;
-        }
-        // find the first chain matching the cert store signing chain
-        auto cbm = cbm_;
-        auto schain = cs_.signingChain();
+        chainBM cbm{};
+        for (size_t d = 0, de = bs.discrim_.size(); d < de; d++) if (ds[d]) cbm |= bs.discrim_[d].cbm;
+        return cbm;
+    }
+    // the subset of candidate chains 'cbm' that signing chain 'chain' matches
+    static chainBM matchingChains(const bSchema& bs, chainBM cbm, const chainRefs& chain) {
         for (auto bm = cbm; bm != 0; ) {
             auto c = std::countr_zero(bm);
             bm &=~ (1u << c);
-            if (!matches(cs_.signingChain(), bs_.chain_[c])) cbm &=~ (1u << c);
+            if (!matches(bs, chain, bs.chain_[c])) cbm &=~ (1u << c);
+        }
+        return cbm;
+    }
+    // value of signing chain 'chain' component that pub template component 'c'
+    // gets from corespondence 'cor' (nullptr if there isn't one)
+    static const ndn_ind::Name::Component* corValue(const bSchema& bs, const chainRefs& chain, bComp c, coridx cor) {
+        c &= SC_VALUE;
+        for (const auto& [cert1, comp1, cert2, comp2] : bs.cor_[cor]) {
+            if (cert1 != 0 || c != comp1) continue;
+            if (cert2 < 1 || size_t(cert2) > chain.size()) return nullptr;
+            const auto& cn = chain[cert2-1]->getName();
+            if (size_t(comp2) >= cn.size()) return nullptr;
+            return &cn[comp2];
+        }
+        return nullptr;
+    }
+    // The templates for pub 'pub' depend only on which schema chains signing
+    // chain 'chain' matches and on the chain component values the templates'
+    // corespondences pick up. This returns a string encoding both so builders
+    // (and validators) for chains with the same 'shape' are interchangeable.
+    static std::string chainShape(const bSchema& bs, bTok pub, const chainRefs& chain) {
+        int pidx = bs.findPub(pub);
+        auto cbm = pubChains(bs, pidx);
+        if (cbm != 0 && (cbm = matchingChains(bs, cbm, chain)) == 0) throw schema_error("no valid signing cert found");
+        std::string res = format("{:x}", cbm);
+        std::vector<const ndn_ind::Name::Component*> seen{};
+        discSet dset{bs.pub_[pidx].d};
+        for (size_t d = 0, de = bs.discrim_.size(); d < de; d++) {
+            if (! dset[d]) continue;
+            const auto& [chainbm,tmplt,comp,vlist,cor] = bs.discrim_[d];
+            if (chainbm && (cbm & chainbm) == 0) continue;
+            for (auto c : bs.tmplt_[tmplt]) {
+                if (! isCor(c)) continue;
+                const auto* v = corValue(bs, chain, c, cor);
+                if (! v) throw schema_error(format("no corespondence for {:02x}", c & SC_VALUE));
+                if (std::find(seen.begin(), seen.end(), v) != seen.end()) continue;
+                seen.emplace_back(v);
+                auto s = v->getValue().toRawStr();
+                res += format("/{}:{}", s.size(), s);
+            }
         }
+        return res;
+    }
+    // find the schema signing chains consistent with the signing chain
+    // used to build the templates.
+    auto findCerts() {
+        cbm_ = pubChains(bs_, pidx_);
+        if (cbm_ == 0) {
+            dprint("chain: not needed\n");
+            return cbm_;
+        }
+        auto cbm = matchingChains(bs_, cbm_, chain_);
         if (cbm == 0) throw schema_error("no valid signing cert found");
-        dprint("chain: {}, signing cert: /{}\n", std::countr_zero(cbm), fmt::join(cs_.signingChain()[0], "/"));
+        dprint("chain: {}, signing cert: /{}\n", std::countr_zero(cbm), fmt::join(chain_[0]->getName(), "/"));
         return cbm;
     }
 
@@ -190,12 +286,9 @@ struct pubBldr {
     // return value of cert[chain[idx]] component 'c' under corespondence 'cor'.
     // If the cor isn't for a pub or the pub's c component doesn't match
     // 'cor' an error is thrown.
-    auto mapCor(auto idx, auto c, auto cor) {
+    auto mapCor(bComp c, coridx cor) {
+        if (const auto* v = corValue(bs_, chain_, c, cor); v) return findOrAddTok(v->getValue().toRawStr());
         c &= SC_VALUE;
-        auto cert = cs_.signingChain();
-        for (const auto& [cert1, comp1, cert2, comp2] : bs_.cor_[cor]) {
-            if (cert1 == idx && c == comp1) return findOrAddTok(cert[cert2-1][comp2].getValue().toRawStr());
-        }
         throw schema_error(format("no corespondence for {:02x}({})", c, tag_[typeValue(c)]));
     }
 
@@ -222,7 +315,7 @@ struct pubBldr {
         }
         // got through components filling in cors from cert chain
         for (auto c : bs_.tmplt_[tmplt]) {
-            if (isCor(c)) c = mapCor(0, c, cor);
+            if (isCor(c)) c = mapCor(c, cor);
             pt.tmplt_.emplace_back(c);
         }
         if (int i = exists(pt); i >= 0) {
@@ -303,13 +396,7 @@ struct pubBldr {
     Comp compValue(const Params& par, bComp c) const {
         if (isLit(c)) return std::string(bs_.tok_[c]);
         if (isIndex(c)) return std::string(ptok_[typeValue(c)]);
-        if (isParam(c)) return std::visit(overloaded {
-                            [](std::monostate) { return Comp("(empty)"s); },
-                            [](std::string_view val) { return Comp(std::string(val)); },
-                            [](std::string val) { return Comp(val); },
-                            [](timeVal val) { return Comp::fromTimestamp(val); },
-                            [](uint64_t val) { return Comp::fromNumber(val); },
-                        }, par[typeValue(c)]);
+        if (isParam(c)) return paramComp(par[typeValue(c)]);
         if (!isCall(c)) throw schema_error(format("invalid comp {} in template", c));
         // handle 'call()' ops
         c = typeValue(c);
@@ -351,6 +438,14 @@ struct pubBldr {
         throw schema_error("no matching pub template");
     }
 
+    // true if template 'pt' would match 'par' for some values of the params in 'wild'
+    bool couldMatch(const Params& par, const pTmplt& pt, const parmSet& wild) const noexcept {
+        for (auto c = 0u; c < par.size(); c++) if (parmbm_[c] && !wild[c] && !checkParVal(par, pt, c)) return false;
+        if (pt.dpar_ >= bs_.tok_.size() || pt.vs_ == 1u || wild[pt.dpar_]) return true;
+        auto t = parToTok(par, pt.dpar_);
+        return t != maxTok && pt.vs_[t];
+    }
+
     Name completeTmplt(const Params& par) const { return fillTmplt(par, matchTmplt(par)); }
 
     // defaults(name, value ...) - set default pub parameter value(s)
@@ -385,6 +480,13 @@ struct pubBldr {
     // An error is thrown otherwise.
     template<typename... Rest>
     Name name(Rest&&... rest) {
+        // find a matching template, fill in params then return it
+        return completeTmplt(params(std::forward<Rest>(rest)...));
+    }
+
+    // convert name() style argument pairs to a complete Params array
+    template<typename... Rest>
+    Params params(Rest&&... rest) {
         static_assert((sizeof...(Rest) & 1) == 0, "must supply name,value argument pairs");
         Params par{};
         par.resize(tag_.size());
@@ -396,8 +498,45 @@ struct pubBldr {
                 par[c] = pdefault_[c];
             }
         }
-        // find a matching template, fill in params then return it
-        return completeTmplt(par);
+        return par;
+    }
+
+    // Prepare a pub name for repeated use. The arguments after 'vary' are the
+    // same as name()'s and select the pub template. 'vary' lists the params
+    // whose values will be changed (via the result's set()) between pubs,
+    // e.g., a segment number. These can't be params that affect which
+    // template is chosen: a discriminator or a param constrained by the chosen
+    // template or by any template ahead of it that some value could match.
+    template<typename... Rest>
+    preparedName prepare(std::initializer_list<std::string_view> vary, Rest&&... rest) {
+        auto par = params(std::forward<Rest>(rest)...);
+        const auto& pt = matchTmplt(par);
+        preparedName pn{};
+        pn.comps_.reserve(pt.tmplt_.size());
+        for (auto c : pt.tmplt_) pn.comps_.emplace_back(compValue(par, c));
+        for (compidx i = 0; i < pt.tmplt_.size(); i++) {
+            if (isCall(pt.tmplt_[i]) && typeValue(pt.tmplt_[i]) == 0) pn.now_.emplace_back(i);
+        }
+        parmSet wild{};
+        for (auto tag : vary) {
+            const auto t = tm_.find(tag);
+            if (t == tm_.end()) throw schema_error(format("no {} parameter for pub", tag));
+            const auto p = t->second;
+            wild[p] = 1;
+            if (pt.vs_.to_ulong() > 1ul && p == pt.dpar_)
+                throw schema_error(format("param {} selects the pub template so can't vary", tag));
+            auto n = pn.vary_.size();
+            for (compidx i = 0; i < pt.tmplt_.size(); i++) {
+                if (isParam(pt.tmplt_[i]) && typeValue(pt.tmplt_[i]) == p) pn.vary_.emplace_back(t->first, i);
+            }
+            if (n == pn.vary_.size()) throw schema_error(format("param {} is constrained by the pub template so can't vary", tag));
+        }
+        // templates ahead of the chosen one take priority so none of them can match any set() value
+        for (const auto* ep = pt_.data(); ep != &pt; ++ep) {
+            if (couldMatch(par, *ep, wild))
+                throw schema_error(format("params {} can select another pub template so can't vary", fmt::join(vary, ",")));
+        }
+        return pn;
     }
 
     // tag name to component index
@@ -412,9 +551,10 @@ struct pubBldr {
     chainBM cbm_{};
     const bSchema& bs_;
     certStore& cs_;
-    std::unordered_map<bTok,bComp> ptm_{}; // pub-specific token map
+    chainRefs chain_;           // signing chain the templates are for
+    tokMap<bComp> ptm_{};       // pub-specific token map
     std::vector<bTok> ptok_{};
-    std::vector<std::string> pstab_{};     // pub-specific string table
+    std::deque<std::string> pstab_{};      // pub-specific string table (ptok_ views its strings)
     int pidx_{-1};              // pub's index in bs_.pub_
 };
 
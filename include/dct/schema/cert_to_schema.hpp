@@ -23,7 +23,6 @@
  *  More information on DCT is available from info@pollere.net
  */
 
-#include <sstream>
 #include "dct_cert.hpp"
 #include "dct/format.hpp"
 #include "dct/sigmgrs/sigmgr_by_type.hpp"
@@ -33,9 +32,9 @@
 // It's assumed that the cert signature has been validated and
 // the cert name checked for conformance to schema conventions.
 bSchema certToSchema(const dctCert& cert) {
-    const auto& pk = *cert.getContent();
-    std::istringstream is(std::string((char*)pk.data(), pk.size()), std::ios::binary);
-    return rdSchema(is).read();
+    // the schema is read in place from the cert's content (which the
+    // result shares, see bSchema)
+    return rdSchema(cert.getContent()).read();
 }
 
 #endif // CERT_TO_SCHEMA_HPP
@@ -24,6 +24,7 @@
  */
 
 #include <algorithm>
+#include <map>
 #include <set>
 #include <span>
 #include <string>
@@ -34,13 +35,95 @@
 using certName = ndn_ind::Name;
 using certVec = std::vector<certName>;
 using certChain = std::vector<thumbPrint>;
+using chainRefs = std::vector<const dctCert*>;  // a signing chain (signing cert first)
 using keyVal = std::vector<uint8_t>;
 using certAddCb = std::function<void(const dctCert&)>;
 using chainAddCb = std::function<void(const dctCert&)>;
 
+// Component trie used to index cert names. A name is added under a run of
+// its components (in reverse order for a suffix index) and lookups return
+// every name added under a path starting with the query's components. The
+// cost is proportional to the size of the result, not of the index.
+struct nameTrie {
+    using Comp = ndn_ind::Name::Component;
+    struct node {
+        std::map<Comp,uint32_t> kids_{};        // next component to child node index
+        std::vector<const certName*> names_{};  // names whose indexed run ends here
+    };
+    std::vector<node> nodes_{1};                // nodes_[0] is the root
+
+    static const Comp& comp(const certName& nm, size_t i, bool rev) { return nm[rev? nm.size() - 1 - i : i]; }
+
+    // add 'nm' under its components from 'first' to the end (or, if 'rev',
+    // its components in reverse order)
+    void add(const certName* nm, size_t first = 0, bool rev = false) {
+        uint32_t n = 0;
+        for (size_t i = first, e = nm->size(); i < e; ++i) {
+            auto [kid, added] = nodes_[n].kids_.try_emplace(comp(*nm, i, rev), nodes_.size());
+            n = kid->second;
+            if (added) nodes_.emplace_back();
+        }
+        nodes_[n].names_.emplace_back(nm);
+    }
+
+    // append the names added under a path starting with 'key' to 'res'
+    void find(const certName& key, bool rev, std::vector<const certName*>& res) const {
+        uint32_t n = 0;
+        for (size_t i = 0, e = key.size(); i < e; ++i) {
+            const auto& kids = nodes_[n].kids_;
+            const auto kid = kids.find(comp(key, i, rev));
+            if (kid == kids.end()) return;
+            n = kid->second;
+        }
+        std::vector<uint32_t> todo{n};
+        while (! todo.empty()) {
+            const auto& nd = nodes_[todo.back()];
+            todo.pop_back();
+            res.insert(res.end(), nd.names_.begin(), nd.names_.end());
+            for (const auto& [c, kid] : nd.kids_) todo.emplace_back(kid);
+        }
+    }
+};
+
 struct certStore {
     std::unordered_map<thumbPrint,dctCert> certs_{}; // validated certs
     std::multimap<certName,thumbPrint> certnames_{}; // name-to-validated cert(s)
+    // Derived lookup state: certnames_ indexed for the prefix, suffix &
+    // substring queries and each cert's resolved signing chain. Both point
+    // into certnames_/certs_ so a copy starts out stale and is rebuilt (from
+    // the copy's certs) on first use.
+    struct certIndex {
+        nameTrie prefix_{};     // names by leading components
+        nameTrie suffix_{};     // names by trailing components
+        nameTrie infix_{};      // names by each of their suffixes
+        std::unordered_map<thumbPrint,chainRefs> chain_{}; // cert's signing chain
+        bool stale_{false};
+
+        certIndex() = default;
+        certIndex(const certIndex&) : stale_{true} {}
+        certIndex(certIndex&&) = default;
+        certIndex& operator=(const certIndex&) { *this = certIndex{}; stale_ = true; return *this; }
+        certIndex& operator=(certIndex&&) = default;
+
+        void add(const certName* nm) {
+            prefix_.add(nm);
+            suffix_.add(nm, 0, true);
+            for (size_t i = 0, n = nm->size(); i < n; ++i) infix_.add(nm, i);
+        }
+        // resolve the chain of 'cert' given its signer's. Returns false if
+        // the signer's chain isn't known (yet).
+        bool addChain(const thumbPrint& tp, const dctCert& cert) {
+            chainRefs ch{&cert};
+            if (const auto& stp = cert.getKeyLoc(); !dctCert::selfSigned(stp)) {
+                const auto sc = chain_.find(stp);
+                if (sc == chain_.end()) return false;
+                ch.insert(ch.end(), sc->second.begin(), sc->second.end());
+            }
+            chain_.try_emplace(tp, std::move(ch));
+            return true;
+        }
+    };
+    mutable certIndex idx_{};
     std::unordered_map<thumbPrint,keyVal> key_{};    // cert-to-key (for signing certs)
     certChain chains_{}; // array of signing chain heads (thumbprints of signing certs)
     certAddCb addCb_{[](const dctCert&){}};          // called when a cert is added
@@ -61,10 +144,11 @@ struct certStore {
 
     auto contains(const thumbPrint& tp) const noexcept { return certs_.contains(tp); }
 
-    // lookup the signing cert of 'data'
-    const dctCert& signingCert(const ndn_ind::Data& data) const {
+    // lookup the signing cert of 'data' (which is 'data' itself if it's self-signed)
+    const ndn_ind::Data& signingCert(const ndn_ind::Data& data) const {
         const auto& tp = dctCert::getKeyLoc(data);
-        return dctCert::selfSigned(tp)? reinterpret_cast<const dctCert&>(data) : get(tp);
+        if (dctCert::selfSigned(tp)) return data;
+        return get(tp);
     }
     const auto& operator[](const ndn_ind::Data& data) const { return signingCert(data); }
 
@@ -74,7 +158,11 @@ struct certStore {
     auto finishAdd(auto it) {
         if (it.second) {
             const auto& [tp, cert] = *it.first;
-            certnames_.emplace(cert.getName(), tp);
+            const auto nm = certnames_.emplace(cert.getName(), tp);
+            if (! idx_.stale_) {
+                idx_.add(&nm->first);
+                idx_.addChain(tp, cert);
+            }
             addCb_(cert);
         }
         return it;
@@ -98,19 +186,48 @@ struct certStore {
         return it;
     }
 
+    // (re)build the index if it's stale. Chains are resolved signer first
+    // (a cert whose signer isn't in the store has no chain).
+    const certIndex& index() const {
+        if (! idx_.stale_) return idx_;
+        idx_ = certIndex{};
+        for (const auto& [n, tp] : certnames_) idx_.add(&n);
+        for (bool added = true; added; ) {
+            added = false;
+            for (const auto& [tp, cert] : certs_) {
+                if (! idx_.chain_.contains(tp) && idx_.addChain(tp, cert)) added = true;
+            }
+        }
+        return idx_;
+    }
+
+    // The signing chain of the cert with thumbprint 'tp' (the cert, its signer,
+    // ..., the trust anchor). Chains are resolved as certs are added so this is
+    // a lookup. Throws if the cert or one of its signers isn't in the store.
+    const chainRefs& chain(const thumbPrint& tp) const { return index().chain_.at(tp); }
+
+    // the signing chain of 'cert', which needn't be in the store (but its signer must be)
+    chainRefs chain(const dctCert& cert) const {
+        chainRefs ch{&cert};
+        if (const auto& stp = cert.getKeyLoc(); !dctCert::selfSigned(stp)) {
+            const auto& sc = chain(stp);
+            ch.insert(ch.end(), sc.begin(), sc.end());
+        }
+        return ch;
+    }
+
     // construct a vector of the names of each cert in cert's signing chain.
     certVec chainNames(const dctCert& cert) const {
         certVec cv{};
-        const auto* c = &cert;
-        cv.emplace_back(c->getName());
-        for (const auto* tp = &c->getKeyLoc(); !dctCert::selfSigned(*tp); tp = &c->getKeyLoc()) {
-            c = &get(*tp);
-            cv.emplace_back(c->getName());
-        }
+        for (const auto* c : chain(cert)) cv.emplace_back(c->getName());
         return cv;
     }
 
-    auto signingChain() const { return chains_.empty()? certVec{} : chainNames(get(chains_[0])); } //XXX
+    // the chain of our (first) signing cert
+    const chainRefs& signingChain() const {
+        static const chainRefs none{};
+        return chains_.empty()? none : chain(chains_[0]);
+    }
 
     void addChain(const dctCert& cert) {
         chains_.emplace_back(cert.computeThumbPrint());
@@ -128,19 +245,35 @@ struct certStore {
         for (const auto& [n, tp] : certnames_) if (pred(n)) cv.emplace_back(n);
         return cv;
     }
+    // The prefix, suffix and substring queries use the name indices. Results
+    // are returned in name order (like copy_if) with one entry per cert.
+    static certVec sortedNames(std::vector<const certName*>&& nms, bool dedup = false) {
+        if (dedup) {
+            std::sort(nms.begin(), nms.end());
+            nms.erase(std::unique(nms.begin(), nms.end()), nms.end());
+        }
+        std::sort(nms.begin(), nms.end(), [](const auto* a, const auto* b) { return *a < *b; });
+        certVec cv{};
+        cv.reserve(nms.size());
+        for (const auto* n : nms) cv.emplace_back(*n);
+        return cv;
+    }
     certVec ends_with(const certName& substr) const {
-        return copy_if([substr](auto c){ return c.getSubName(-substr.size()) == substr; });
+        std::vector<const certName*> res{};
+        index().suffix_.find(substr, true, res);
+        return sortedNames(std::move(res));
     }
     certVec starts_with(const certName& substr) const {
-        return copy_if([substr](auto c){ return c.getPrefix(substr.size()) == substr; });
+        std::vector<const certName*> res{};
+        index().prefix_.find(substr, false, res);
+        return sortedNames(std::move(res));
     }
+    // names containing 'substr' as a run of components. A name can contain
+    // it more than once so the result is de-duplicated.
     certVec match(const certName& substr) const {
-        return copy_if([substr](auto c){
-                for (int i = 0, n = c.size() - substr.size(); i < n; i++) {
-                    if (c.getSubName(i, substr.size()) == substr) return true; 
-                }
-                return false;
-            });
+        std::vector<const certName*> res{};
+        index().infix_.find(substr, false, res);
+        return sortedNames(std::move(res), true);
     }
 
     //default just calls the start callback with true (e.g., okay to start)
@@ -150,7 +283,7 @@ struct certStore {
 static inline certVec match(const certVec& in, const certName& substr) {
     certVec cv{};
     for (const auto& c : in) {
-        for (int i = 0, n = c.size() - substr.size(); i < n; i++) {
+        for (int i = 0, n = c.size() - substr.size(); i <= n; i++) {
             if (c.getSubName(i, substr.size()) == substr) { cv.emplace_back(c); break; }
         }
     }
@@ -0,0 +1,170 @@
+#ifndef COMPACT_NAME_HPP
+#define COMPACT_NAME_HPP
+/*
+ * Compact on-the-wire encoding of pub names using a schema's token table
+ *
+ * Copyright (C) 2021 Pollere, Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, see <https://www.gnu.org/licenses/>.
+ *  You may contact Pollere, Inc at info@pollere.net.
+ *
+ *  The DCT proof-of-concept is not intended as production code.
+ *  More information on DCT is available from info@pollere.net
+ */
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "bschema.hpp"
+
+// Most of the components of a pub's name are literals of its schema (e.g.,
+// the pub prefix, targets and topics) and every member of a trust domain has
+// the same schema so these strings don't need to be sent. A compact pub is
+// the pub's wire format (an NDN Data TLV) without the outer Data type & length
+// and with each generic name component whose value is a schema token replaced
+// by one byte: 0x80 | token index. Other components are copied as is (their
+// TLV type is always < 0x80 so there's no ambiguity).
+//
+// Since the pub's signature covers the encoded name, expanding a compact pub
+// must give back exactly the original bytes. Expansion uses minimal TLV length
+// encodings so a pub whose Data, Name or token component lengths aren't
+// minimally encoded (which won't happen for pubs built with ndn-ind) isn't
+// compacted.
+struct nameCodec {
+    using bytes = std::vector<uint8_t>;
+    using rdSpan = std::span<const uint8_t>;
+    static constexpr uint8_t tlvData = 6;
+    static constexpr uint8_t tlvName = 7;
+    static constexpr uint8_t tlvGeneric = 8;
+    static constexpr uint8_t tokRef = 0x80;
+
+    const bSchema& bs_;
+
+    nameCodec(const bSchema& bs) : bs_{bs} { }
+
+    // NDN TLV 'var-number' read/write (values < 64K which is all a pub can be)
+    static size_t varSize(size_t v) noexcept { return v < 253? 1 : 3; }
+    static void putVar(bytes& out, size_t v) {
+        if (v < 253) {
+            out.emplace_back(v);
+        } else {
+            out.emplace_back(253);
+            out.emplace_back(v >> 8);
+            out.emplace_back(v);
+        }
+    }
+    // read a var-number at 'p' (advancing it). Returns false if it doesn't fit
+    // in 'e - p' bytes or is too large.
+    static bool getVar(const uint8_t*& p, const uint8_t* e, size_t& v) noexcept {
+        if (p >= e) return false;
+        if (*p < 253) {
+            v = *p++;
+            return true;
+        }
+        if (*p != 253 || e - p < 3) return false;
+        v = (size_t(p[1]) << 8) | p[2];
+        p += 3;
+        return true;
+    }
+    // read a TLV header at 'p' (advancing it) whose value must fit before 'e'
+    static bool getTL(const uint8_t*& p, const uint8_t* e, size_t& type, size_t& len) noexcept {
+        auto s = p;
+        if (! getVar(p, e, type) || ! getVar(p, e, len) || len > size_t(e - p)) {
+            p = s;
+            return false;
+        }
+        return true;
+    }
+
+    // set 'out' to the compact form of pub wire format 'wf'. Returns false
+    // (and 'out' is unusable) if 'wf' can't be compacted.
+    bool compact(rdSpan wf, bytes& out) const {
+        out.clear();
+        const uint8_t* p = wf.data();
+        const uint8_t* e = p + wf.size();
+        size_t t, len;
+        if (! getTL(p, e, t, len) || t != tlvData || p + len != e || size_t(p - wf.data()) != 1 + varSize(len))
+            return false;
+        const auto* np = p;
+        if (! getTL(p, e, t, len) || t != tlvName || size_t(p - np) != 1 + varSize(len)) return false;
+        const auto* ne = p + len;
+
+        bytes nm{};
+        nm.reserve(len);
+        while (p < ne) {
+            const auto* cp = p;
+            if (*p >= tokRef || ! getTL(p, ne, t, len)) return false;
+            if (t == tlvGeneric && p - cp == 2) {
+                auto v = bs_.tm_.find(std::string_view((const char*)p, len));
+                if (v != bs_.tm_.end() && v->second < maxTok) {
+                    nm.emplace_back(tokRef | v->second);
+                    p += len;
+                    continue;
+                }
+            }
+            p += len;
+            nm.insert(nm.end(), cp, p);
+        }
+        out.reserve(1 + varSize(nm.size()) + nm.size() + (e - ne));
+        out.emplace_back(tlvName);
+        putVar(out, nm.size());
+        out.insert(out.end(), nm.begin(), nm.end());
+        out.insert(out.end(), ne, e);
+        return true;
+    }
+
+    // set 'out' to the pub wire format for compact pub 'cp'. Returns false if
+    // 'cp' is malformed or refers to tokens the schema doesn't have.
+    bool expand(rdSpan cp, bytes& out) const {
+        out.clear();
+        const uint8_t* p = cp.data();
+        const uint8_t* e = p + cp.size();
+        size_t t, len;
+        if (! getTL(p, e, t, len) || t != tlvName) return false;
+        const auto* ne = p + len;
+
+        // expand the name components then add the TLV headers
+        bytes nm{};
+        nm.reserve(len * 2);
+        while (p < ne) {
+            if (*p >= tokRef) {
+                const size_t tok = *p++ & 0x7f;
+                if (tok >= bs_.tok_.size()) return false;
+                const auto& s = bs_.tok_[tok];
+                nm.emplace_back(tlvGeneric);
+                putVar(nm, s.size());
+                nm.insert(nm.end(), s.begin(), s.end());
+                continue;
+            }
+            const auto* cs = p;
+            if (! getTL(p, ne, t, len)) return false;
+            p += len;
+            nm.insert(nm.end(), cs, p);
+        }
+        const size_t nameTLV = 1 + varSize(nm.size()) + nm.size();
+        const size_t dlen = nameTLV + (e - ne);
+        if (dlen > 0xffff) return false;
+        out.reserve(1 + varSize(dlen) + dlen);
+        out.emplace_back(tlvData);
+        putVar(out, dlen);
+        out.emplace_back(tlvName);
+        putVar(out, nm.size());
+        out.insert(out.end(), nm.begin(), nm.end());
+        out.insert(out.end(), ne, e);
+        return true;
+    }
+};
+
+#endif // COMPACT_NAME_HPP
@@ -77,10 +77,12 @@ using certName = ndn_ind::Name;
 
 struct dctCert : ndn_ind::Data {
     // dctCert is a certificate that has contraints on its key locator (which are checked at
-    // sign/validate time). dctCert is derived from ndn_ind::Data
+    // sign/validate time). dctCert is derived from ndn_ind::Data. A cert's thumbprint, key
+    // locator and signature type are used constantly so they're extracted once, when the
+    // dctCert is constructed, and a dctCert shouldn't be modified after construction.
 
-    dctCert(const ndn_ind::Data& p) { *this = reinterpret_cast<const dctCert&>(p); }
-    dctCert(ndn_ind::Data&& p) { *this = std::move(reinterpret_cast<dctCert&&>(p)); }
+    dctCert(const ndn_ind::Data& p) : ndn_ind::Data(p) { cacheFields(); }
+    dctCert(ndn_ind::Data&& p) : ndn_ind::Data(std::move(p)) { cacheFields(); }
 
     // construct a dctCert with the given name. The name will be suffixed with the
     // 4 required NDN components (KEY/<kid>/<creator>/<creationTime>), have content type
@@ -126,6 +128,7 @@ struct dctCert : ndn_ind::Data {
           //_LOG_ERROR("dctCert(" << nm << ") signing failed");
           exit(1);
         }
+        cacheFields();
     }
  
     // a hash that's 32 bytes of zero is the thumbprint of a "self-signed" cert. The DCT model
@@ -149,7 +152,24 @@ struct dctCert : ndn_ind::Data {
         crypto_hash_sha256(tp.data(), certWF.buf(), certWF.size());
         return tp;
     }
+    // The SigInfo DCT's sigmgrs generate for pubs holds only the sig type and
+    // thumbprint locator, in that order. SigInfo is the last block of the signed
+    // portion of the wire encoding so, when this 9 byte header is 41 bytes from
+    // the end of the signed portion, the locator is the last 32 bytes of it.
+    // ('T' is the sig type which can be anything.)
+    static constexpr std::array<uint8_t,9> pubSigInfo{ 22, 39, 27, 1, 'T', 28, 34, 29, 32 };
+
     static inline const thumbPrint& getKeyLoc(const ndn_ind::Data& data) {
+        // fast path: pub SigInfo at the end of the signed portion
+        const auto wf = data.wireEncode();
+        if (const auto n = wf.signedSize(); n >= pubSigInfo.size() + thumbPrint_s &&
+                                            wf.getSignedPortionBeginOffset() + n <= wf.size()) {
+            const auto* si = wf.signedBuf() + n - (pubSigInfo.size() + thumbPrint_s);
+            if (std::equal(pubSigInfo.begin(), pubSigInfo.begin() + 4, si) &&
+                std::equal(pubSigInfo.begin() + 5, pubSigInfo.end(), si + 5)) {
+                return (const thumbPrint&)*(si + pubSigInfo.size());
+            }
+        }
         // find the SigInfo (tlv 22) block of 'data' then get its key locator (tlv 28)
         auto si = tlvParser(data).findBlk(22).findBlk(28);
         if (! si.starts_with(kloc_preamble, 0)) throw runtime_error("KeyLocator isn't a DCT thumbprint");
@@ -157,12 +177,6 @@ struct dctCert : ndn_ind::Data {
         return (const thumbPrint&)*(si.data() + sizeof(kloc_preamble));
     }
 
-    const thumbPrint& getKeyLoc() const { return getKeyLoc(*this); }
-
-    auto selfSigned() const { return selfSigned(getKeyLoc()); }
-
-    thumbPrint computeThumbPrint() const { return computeThumbPrint(*this); }
-
     // return the 'signature type' (tlv 27) byte of 'data'
     static inline auto getSigType(const ndn_ind::Data& data) {
         // find the SigInfo (tlv 22) block of 'data' then its sigType (tlv 27) block
@@ -170,7 +184,31 @@ struct dctCert : ndn_ind::Data {
         if (st.size() != 3) throw runtime_error("malformed Data: multi-byte signature type");
         return st[2];
     }
-    auto getSigType() const { return getSigType(*this); }
+
+    // A cert whose locator or sig type can't be parsed (which can only come
+    // from a peer) isn't usable but the error is reported where these fields
+    // are used (as it would be without the cache) rather than at construction.
+    void cacheFields() {
+        tp_ = computeThumbPrint(*this);
+        try {
+            kloc_ = getKeyLoc(*this);
+            sigType_ = getSigType(*this);
+            parsed_ = true;
+        } catch (const std::exception&) { parsed_ = false; }
+    }
+
+    const thumbPrint& getKeyLoc() const { return parsed_? kloc_ : getKeyLoc(*this); }
+
+    auto selfSigned() const { return selfSigned(getKeyLoc()); }
+
+    const thumbPrint& computeThumbPrint() const noexcept { return tp_; }
+
+    uint8_t getSigType() const { return parsed_? sigType_ : getSigType(*this); }
+
+    thumbPrint tp_{};       // cert's thumbprint
+    thumbPrint kloc_{};     // thumbprint of its signing cert
+    uint8_t sigType_{};
+    bool parsed_{false};    // kloc_ & sigType_ are valid
 };
 
 template<> struct std::hash<dctCert> {
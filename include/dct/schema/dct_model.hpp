@@ -24,15 +24,26 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <exception>
 #include <functional>
+#include <map>
+#include <memory>
+#include <span>
 #include <string_view>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 #include "buildpub.hpp"
 #include "certstore.hpp"
+#include "compact_name.hpp"
 #include "dct/format.hpp"
+#include "dct/reject_cache.hpp"
 #include "dct/utility.hpp"
+#include "dct/worker_pool.hpp"
+#include "pending_certs.hpp"
 #include "validate_bootstrap.hpp"
 #include "validate_pub.hpp"
 #include "dct/distributors/dist_cert.hpp"
@@ -41,28 +52,69 @@
 
 using Publication = ndn_ind::Data;
 
-//template<typename sPub>
-struct DCTmodel {
+// DCTmodelT is parameterized by the types of its pub and wire sigmgrs. The
+// default (SigMgrAny) accepts whatever signer types the trust schema
+// specifies. An app built for a particular schema can instead name the
+// concrete sigmgrs (e.g., DCTmodelT<SigMgrEdDSA,SigMgrAEAD>) so all the
+// per-packet crypto calls are bound at compile time. In that case the
+// constructor throws if the schema's signer types don't match.
+template<typename PubSM = SigMgrAny, typename WireSM = SigMgrAny>
+struct DCTmodelT {
+    using pubPolicy = sigmgrPolicy<PubSM>;
+    using wirePolicy = sigmgrPolicy<WireSM>;
+
     certStore cs_{};        // certificates used by this model instance
-    std::unordered_multimap<thumbPrint,dctCert> pending_{};
+    pendingCerts pending_{};    // certs waiting for their signing cert
+    rejectCache certRejects_{}; // thumbprints of certs that failed validation
+    failLimiter certFails_{};   // per-signer cert validation failure rate limit
+    pendingCerts shedCerts_{256, 32};   // certs shed by certFails_ waiting to be rechecked
     const bSchema& bs_;     // trust schema for this model instance
     pubBldr<false> bld_;    // publication builder/verifier
-    SigMgrAny psm_;         // publication signing/validation
-    SigMgrAny wsm_;         // wire packet signing/validation
-    SigMgrSchema syncSm_;   // syncps pub validator
-    syncps::SyncPubsub m_sync;  // sync collection for pubs
-    static inline std::function<size_t(std::string_view)> _s2i;
+    PubSM psm_;             // publication signing/validation
+    WireSM wsm_;            // wire packet signing/validation
+    SigMgrSchemaT<PubSM> syncSm_;   // syncps pub validator
+    syncps::SyncPubsubT<WireSM,SigMgrSchemaT<PubSM>> m_sync;  // sync collection for pubs
+    static inline typename pubBldr<false>::tagMap _tm{};   // pub tag to name component index
     DistCert m_ckd;         // cert collection distributor
     DistGKey* m_gkd{};      // group key distributor (if needed)
+    Timer shedTimer_{};     // recheck of shedCerts_
+    bool shedSched_{false}; // shedTimer_ is scheduled
     tpToValidator pv_{};    // map signer thumbprint to pub structural validator
-
-    SigMgr& wireSigMgr() { return wsm_.ref(); }
-    SigMgr& pubSigMgr() { return psm_.ref(); }
+    std::unordered_map<std::string,std::shared_ptr<const pubValidator>> pvShape_{}; // validators by chain shape
+    std::array<uint8_t,crypto_hash_sha256_BYTES> digest_{}; // SHA-256 of the binary schema
+
+    // state for pubAsync (pool_ is last so it's destroyed, and its workers
+    // joined, before anything they use)
+    using PubReadyCb = std::function<void(Publication&&, bool)>;
+    struct asyncPub {
+        Publication pub{};
+        PubReadyCb cb{};
+        bool ok{false};
+    };
+    std::map<uint64_t,asyncPub> asyncDone_{}; // signed pubs waiting for their turn
+    uint64_t asyncSeq_{};                     // sequence number of next pubAsync
+    uint64_t asyncNext_{};                    // sequence number of next pub to deliver
+    uint64_t asyncFails_{};                   // pubAsync pubs that couldn't be built or signed
+    std::unique_ptr<workerPool> pool_{};      // pubAsync workers (created on first use)
+
+    SigMgr& wireSigMgr() { return wirePolicy::ref(wsm_); }
+    SigMgr& pubSigMgr() { return pubPolicy::ref(psm_); }
     auto pubPrefix() const { return bs_.pubVal("#pubPrefix"); }
     auto wirePrefix() const { return bs_.pubVal("#wirePrefix"); }
 
     const auto& certs() const { return cs_; }
 
+    // SHA-256 of the binary schema (the content of the bootstrap's schema
+    // cert). Code generated from a schema by tools/schema_codegen embeds this
+    // so it can tell if it's running with the schema it was generated from.
+    const auto& schemaDigest() const noexcept { return digest_; }
+
+    // Have arriving pubs whose names fail 'f' dropped before their signature
+    // is checked. 'f' must never reject a valid name (e.g., the matches()
+    // schema_codegen generates for this schema's pub, see its prefilter()).
+    using pubFilter = typename SigMgrSchemaT<PubSM>::pubFilter;
+    void pubPrefilter(pubFilter f) noexcept { syncSm_.prefilter_ = f; }
+
     bool isSigningCert(const dctCert& cert) const {
         // signing certs are the first item each signing chain so go through
         // all the chains and see if the first item matches 'cert'
@@ -75,111 +127,174 @@ struct DCTmodel {
 
     // setup the information needed to validate pubs signed with the cert
     // associated with 'tp' which is the head of schema signing chain 'chain'.
+    // The pub templates only depend on the 'shape' of the signing chain (the
+    // schema chains it matches and the cert values its corespondences use)
+    // so the validator is built once per shape and shared by all the signers
+    // with that shape. The templates are built from the chain's certs so
+    // the certstore isn't copied.
     void setupPubValidator(const thumbPrint& tp) {
-        //XXX this is a hack and should be refactored
-        // Make a temporary builder to construct the pub templates associated
-        // with this signing chain. To do this we need a *copy* of the current
-        // certstore with its signing chain 0 set to 'tp'.
-        certStore cs = cs_;
-        cs.chains_[0] = tp;
-        pubBldr bld(bs_, cs, bs_.pubName(0));
-        pv_.emplace(tp, pubValidator(std::move(bld.pt_), std::move(bld.ptm_),
-                                     std::move(bld.ptok_), std::move(bld.pstab_)));
-    }
-
-    // Check if newly added cert 'tp' allows validation of pending cert(s)
-    // Validating and adding a pending cert may allow others to be validated
-    // so this routine can get called recursively but the recursion depth
-    // should be at most the schema's max signing chain length - 2.
-    void checkPendingCerts(const dctCert& cert, const thumbPrint& tp) {
-        auto [b, e] = pending_.equal_range(tp);
-        if (b == e) return;
-        for (auto i = b; i != e; ++i) {
-            auto& p = i->second;
-            if (pubSigMgr().validate(p, cert)) addCert(p);
+        const auto& chain = cs_.chain(tp);
+        auto& pv = pvShape_[pubBldr<>::chainShape(bs_, bs_.pubName(0), chain)];
+        if (! pv) {
+            pubBldr bld(bs_, cs_, bs_.pubName(0), chain);
+            pv = std::make_shared<const pubValidator>(bs_, std::move(bld.pt_), std::move(bld.ptm_),
+                                                      std::move(bld.ptok_), std::move(bld.pstab_));
         }
-        pending_.erase(tp);
+        pv_.emplace(tp, pv);
     }
 
-    // Cryptographically and structurally validate a cert before adding it to the
-    // cert store. Since certs can arrive in any order, a small number of certs
-    // are held pending their signing cert's arrival.
-    void addCert(const dctCert& cert) {
-        const auto tp = cert.computeThumbPrint();
-        if (cs_.contains(tp)) return;
+    // Cryptographically and structurally validate a cert then add it to the
+    // cert store. Returns true if the cert was added. Since certs can arrive in
+    // any order, a cert whose signing cert hasn't arrived is held in pending_
+    // and checked when that arrives. Certs that fail are remembered so copies
+    // of them are dropped without redoing the checks and, if certs claiming
+    // some signer fail their signature or chain checks at a high rate, that
+    // signer's certs are shed for a while. Cert distributors only deliver a
+    // cert once so shed certs that pass the cheap schema checks are held in
+    // shedCerts_ and checked (without shedding) after the holdoff. 'shed' is
+    // false for that recheck. A cert pushed out of shedCerts_ (e.g., by a flood
+    // of junk certs claiming the same signer) is fetched again.
+    bool addValidCert(const dctCert& cert, bool shed = true) {
+        const auto& tp = cert.computeThumbPrint();
+        if (cs_.contains(tp)) return false;
+        const auto tph = std::hash<thumbPrint>{}(tp);
+        if (certRejects_.contains(tph)) return false;
         // check if cert is consistent with the schema
         try {
-            auto ctype = cert.getSigType();
-            if (ctype != pubSigMgr().type()) return; // signature doesn't match schema
-
-            const auto& cname = cert.getName();
-            if (matchesAny(bs_, cname) < 0) return; // name doesn't match schema
-
-            // new root certs and schemas arriving in a session generally
-            // result from a configuration error (e.g., updating a schema in
-            // some but not all id bundles) so ignore them.
-            // XXX eventually need tools to securely check/update certs & bundles
             const auto& stp = cert.getKeyLoc();
-            if (dctCert::selfSigned(stp)) {
-                //_LOG_WARNING("ignoring new root cert " << cname);
-                return;
-            }
-            if (cname.size() >= 8 && to_sv(cname[-6]) == "schema") {
-                //_LOG_WARNING("ignoring new schema cert " << cname);
-                return;
+            if (screenCert(cert, stp) == certCheck::ok) {
+                const auto src = std::hash<thumbPrint>{}(stp);
+                if (shed && certFails_.shedding(src)) {
+                    deferShedCert(stp, tp, cert);
+                    return false;
+                }
+                const auto res = checkCert(cert, tp, stp);
+                if (res == certCheck::ok) return cs_.contains(tp); // (false if pending)
+                if (res == certCheck::failed) certFails_.fail(src);
             }
+        } catch (const std::exception&) {};
+        certRejects_.add(tph);
+        return false;
+    }
 
-            // cert is structurally ok so see if it crytographically validates
-            if (! cs_.contains(stp)) {
-                // don't have cert's signing cert - check it when that arrives
-                if (pending_.size() > 32) {
-                    // XXX too many pending certs - drop something
-                } 
-                pending_.emplace(stp, cert);
-                return;
-            }
-            if (! pubSigMgr().validate(cert, cs_[stp])) return;
-
-            if (isSigningCert(cert)) {
-                // we validated a signing cert which means we have its entire chain
-                // in the certstore so we can validate all the names in the chain
-                // against the schema. If the chain is ok, set up structural validation
-                // state for pubs signed with this thumbprint.
-                auto chain = validateChain(bs_, cs_, cert);
-                if (chain < 0) return; // chain structurally invalid
-                cs_.add(cert);
-                setupPubValidator(tp);
-                return; // done since nothing can be pending on a signing cert
-            }
+    // hold a shed cert until its signer's holdoff has passed then recheck it
+    void deferShedCert(const thumbPrint& stp, const thumbPrint& tp, const dctCert& cert) {
+        shedCerts_.add(stp, tp, cert, isSigningCert(cert));
+        if (shedSched_) return;
+        shedSched_ = true;
+        shedTimer_ = m_sync.schedule(certFails_.holdoff_, [this] {
+                            shedSched_ = false;
+                            for (const auto& c : shedCerts_.takeAll()) addCert(c, false);
+                        });
+    }
+
+    // Result of checking a cert. 'rejected' certs are inconsistent with the
+    // schema or (e.g., a new root or schema cert) with this configuration and
+    // are cheap to detect. 'failed' certs have a signature that doesn't verify
+    // against the cert's signing cert or a chain that doesn't match the schema.
+    // Only 'failed' counts toward the signer's failure rate.
+    enum class certCheck { ok, rejected, failed };
+
+    // Cheap checks of 'cert' (signed by 'stp') against the schema and
+    // configuration. Returns 'ok' or 'rejected'.
+    certCheck screenCert(const dctCert& cert, const thumbPrint& stp) {
+        auto ctype = cert.getSigType();
+        if (ctype != pubSigMgr().type()) return certCheck::rejected; // signature doesn't match schema
+
+        const auto& cname = cert.getName();
+        if (matchesAny(bs_, cname) < 0) return certCheck::rejected; // name doesn't match schema
+
+        // new root certs and schemas arriving in a session generally
+        // result from a configuration error (e.g., updating a schema in
+        // some but not all id bundles) so ignore them.
+        // XXX eventually need tools to securely check/update certs & bundles
+        if (dctCert::selfSigned(stp)) {
+            //_LOG_WARNING("ignoring new root cert " << cname);
+            return certCheck::rejected;
+        }
+        if (cname.size() >= 8 && to_sv(cname[-6]) == "schema") {
+            //_LOG_WARNING("ignoring new schema cert " << cname);
+            return certCheck::rejected;
+        }
+        return certCheck::ok;
+    }
+
+    // Check a 'cert' (with thumbprint 'tp', signed by 'stp') that passed
+    // screenCert. If it's ok it has been added to the cert store or, if its
+    // signing cert hasn't arrived, to pending_.
+    certCheck checkCert(const dctCert& cert, const thumbPrint& tp, const thumbPrint& stp) {
+        // cert is structurally ok so see if it crytographically validates
+        if (! cs_.contains(stp)) {
+            // don't have cert's signing cert - check it when that arrives
+            // (signing certs are kept in preference to others)
+            pending_.add(stp, tp, cert, isSigningCert(cert));
+            return certCheck::ok;
+        }
+        if (! pubPolicy::validate(psm_, cert, cs_[stp])) return certCheck::failed;
+
+        if (isSigningCert(cert)) {
+            // we validated a signing cert which means we have its entire chain
+            // in the certstore so we can validate all the names in the chain
+            // against the schema. If the chain is ok, set up structural validation
+            // state for pubs signed with this thumbprint.
+            auto chain = validateChain(bs_, cs_, cert);
+            if (chain < 0) return certCheck::failed; // chain structurally invalid
             cs_.add(cert);
-        } catch (const std::exception&) {};
-        checkPendingCerts(cert, tp);
+            setupPubValidator(tp);
+            return certCheck::ok;
+        }
+        cs_.add(cert);
+        return certCheck::ok;
     }
 
+    // Add a cert then any pending certs it allows to be validated. Adding a
+    // pending cert may in turn allow others to be validated so this works
+    // through a list of newly added certs rather than recursing.
+    void addCert(const dctCert& cert, bool shed = true) {
+        if (! addValidCert(cert, shed)) return;
+        std::vector<thumbPrint> added{cert.computeThumbPrint()};
+        while (! added.empty()) {
+            const auto tp = added.back();
+            added.pop_back();
+            if (pending_.empty()) break;
+            for (const auto& p : pending_.take(tp)) {
+                if (addValidCert(p)) added.emplace_back(p.computeThumbPrint());
+            }
+        }
+    }
+
+    // pending cert store occupancy and eviction counts
+    const auto& pendingStats() const noexcept { return pending_.getStats(); }
+    auto pendingDepth() const noexcept { return pending_.size(); }
+    // invalid cert cache hits and certs shed by the failure rate limit
+    auto certRejectHits() const noexcept { return certRejects_.hits(); }
+    auto certsShed() const noexcept { return certFails_.shed(); }
+    auto shedDepth() const noexcept { return shedCerts_.size(); }
 
     // create a new DCTmodel instance using the certs in the bootstrap bundle file 'bootstrap'
-    DCTmodel(std::string_view bootstrap) :
+    DCTmodelT(std::string_view bootstrap) :
             bs_{validateBootstrap(bootstrap, cs_)},
             bld_{pubBldr(bs_, cs_, bs_.pubName(0))},
-            psm_{getSigMgr(bs_)},
-            wsm_{getWireSigMgr(bs_)},
-            syncSm_{psm_.ref(), bs_, pv_},
-            m_sync{syncps::SyncPubsub(wirePrefix() + "/pub", wireSigMgr(), syncSm_
+            psm_{sigMgrAs<PubSM>(getSigMgr(bs_))},
+            wsm_{sigMgrAs<WireSM>(getWireSigMgr(bs_))},
+            syncSm_{psm_, bs_, pv_},
 #ifdef SYNCPS_IS_SVS
-                   , cs_
+            m_sync{wirePrefix() + "/pub", wireSigMgr(), syncSm_, cs_},
+#else
+            m_sync{wirePrefix() + "/pub", wsm_, syncSm_},
 #endif
-            )},
             m_ckd{ bs_.pubVal("#pubPrefix"), bs_.pubVal("#wirePrefix") + "/cert",
                    [this](auto cert){ addCert(cert);},  [](auto /*p*/){return false;}, cs_ }
     {
-        if(wsm_.ref().type() == SigMgr::stAEAD) {
+        // wire sigmgrs that use a symmetric group key need a group key distributor
+        if (auto wt = wireSigMgr().type(); wt == SigMgr::stAEAD || wt == SigMgr::stAEADGCM || wt == SigMgr::stMAC) {
             m_gkd = new DistGKey(pubPrefix(), wirePrefix() + "/key",
-                             [this](auto& gk, auto gkt){ wsm_.ref().addKey(gk, gkt);}, certs());
+                             [this](auto& gk, auto gkt){ wireSigMgr().addKey(gk, gkt);}, certs());
         }
         // cert distributor needs a callback when cert added to certstore.
         // when it's set up, push all the certs that went in prior to the
         // callback to the distributor (all the bootstrap info).
-        // If using AEAD wireSigMgr, the group key distributor needs an update for new members
+        // If using a group key wireSigMgr, the group key distributor needs an update for new members
         //  (but shouldn't call with its own signing key)
         if (m_gkd) {
             cs_.addCb_ = [this, &ckd=m_ckd, &gkd=*m_gkd] (const dctCert& cert) {
@@ -200,8 +315,30 @@ struct DCTmodel {
         wireSigMgr().setKeyCb([&cs=cs_](const ndn_ind::Data& d) -> const keyVal& { return *(cs[d].getContent()); });
 
 
-        // SPub need access to builder's 'index' function to translate component names to indices
-        _s2i = std::bind(&decltype(bld_)::index, bld_, std::placeholders::_1);
+#ifndef SYNCPS_IS_SVS
+        // pubs from members sending compact names are expanded using the schema
+        m_sync.expandPubCb([this](auto cp, auto& wf) { return nameCodec(bs_).expand(cp, wf); });
+
+        // rate limit pub validation failures by the member that sent them.
+        // A pub's own key locator is chosen by its sender and isn't verified
+        // until the pub validates, so the source is the signer of the sync Data
+        // that carried it. Only an EdDSA wire signature identifies that member
+        // (group key sigmgrs don't) so otherwise nothing is shed.
+        if (wireSigMgr().type() == SigMgr::stEdDSA) {
+            m_sync.pubSourceCb([](const ndn_ind::Data& d, const Publication&) -> uint64_t {
+                        try { return std::hash<thumbPrint>{}(dctCert::getKeyLoc(d)); }
+                        catch (const std::exception&) { return 0; } });
+        }
+#endif
+
+        // certs dropped from the pending store have to be fetched again
+        pending_.evictCb_ = [this](const dctCert& c) { m_ckd.refetch(c); };
+        shedCerts_.evictCb_ = [this](const dctCert& c) { m_ckd.refetch(c); };
+
+        if (bs_.buf_) crypto_hash_sha256(digest_.data(), bs_.buf_->data(), bs_.buf_->size());
+
+        // sPub needs the builder's tag map to translate tag names to component indices
+        _tm = bld_.tm_;
     }
 
     // export the syncps API
@@ -222,6 +359,16 @@ struct DCTmodel {
         return m_sync.publish(std::move(pub), std::move(cb));
     }
 
+#ifndef SYNCPS_IS_SVS
+    // Send pubs with their schema literal name components replaced by token
+    // indices (see compact_name.hpp) so more fit in each sync Data. Members
+    // built without this support can't read them so it's off by default.
+    auto& compactPubNames() {
+        m_sync.compactPubCb([this](auto wf, auto& cp) { return nameCodec(bs_).compact(wf, cp); });
+        return *this;
+    }
+#endif
+
     auto& setSyncInterestLifetime(std::chrono::milliseconds t) {
         (void) t;
 #ifndef SYNCPS_IS_SVS
@@ -233,18 +380,108 @@ struct DCTmodel {
         return m_sync.schedule(after, cb);
     }
 
-    // construct a pub name
+    // construct a pub name (from name,value argument pairs or a preparedName)
+    template<typename... Rest>
+    auto name(Rest&&... rest) {
+        if constexpr ((std::is_same_v<std::remove_cvref_t<Rest>, preparedName> && ...) && sizeof...(Rest) == 1) {
+            return (rest.name(), ...);
+        } else {
+            return bld_.name(std::forward<Rest>(rest)...);
+        }
+    }
+
+    // prepare a pub name for repeated use where only the params in 'vary'
+    // change between pubs (see pubBldr::prepare). The result can be given to
+    // pub(), unsignedPub() or publishAsync() in place of the name arguments.
     template<typename... Rest>
-    auto name(Rest&&... rest) { return bld_.name(std::forward<Rest>(rest)...); }
+    auto prepare(std::initializer_list<std::string_view> vary, Rest&&... rest) {
+        return bld_.prepare(vary, std::forward<Rest>(rest)...);
+    }
 
     // construct a publication with the given content using rest of args to construct its name
     template<typename... Rest>
     auto pub(std::span<const uint8_t> content, Rest&&... rest) {
+        auto pub = unsignedPub(content, std::forward<Rest>(rest)...);
+        pubPolicy::sign(psm_, pub);
+        return pub;
+    }
+
+    // construct a publication but don't sign it (for use with signBatch)
+    template<typename... Rest>
+    auto unsignedPub(std::span<const uint8_t> content, Rest&&... rest) {
         Publication pub(name(std::forward<Rest>(rest)...));
-        pubSigMgr().sign(pub.setContent(content.data(), content.size()));
+        pub.setContent(content.data(), content.size());
         return pub;
     }
 
+    // sign a batch of pubs made by unsignedPub. If the pub sigmgr supports it
+    // (pubSigMgr().batchSigning()) the batch is covered by a single signature.
+    bool signBatch(std::span<Publication> pubs) { return pubPolicy::signBatch(psm_, pubs); }
+
+    // Construct and sign a publication on a worker thread then call 'cb' with
+    // it on the io thread. Signed pubs are handed to their callbacks in the
+    // order the pubAsync calls were made. Like the rest of this API, pubAsync
+    // should be called from the io thread. Name arguments are copied so they
+    // needn't outlive the call. Since the pub sigmgr signs on several threads
+    // at once, its signing key & defaults() shouldn't change while async pubs
+    // are outstanding. 'cb' is called with ok = true and the signed pub or, if
+    // building or signing the pub failed, with ok = false and the pub as far
+    // as it got (its name is empty if the name couldn't be built).
+    template<typename... Rest>
+    void pubAsync(PubReadyCb&& cb, std::span<const uint8_t> content, Rest&&... rest) {
+        if (! pool_) pool_ = std::make_unique<workerPool>();
+        pool_->post([this, seq = asyncSeq_++, cb = std::move(cb),
+                     content = std::vector<uint8_t>(content.begin(), content.end()),
+                     args = std::make_tuple(ownArg(std::forward<Rest>(rest))...)]() mutable {
+                asyncPub ap{{}, std::move(cb), false};
+                try {
+                    ap.pub = Publication(std::apply([this](auto&... a) { return name(a...); }, args));
+                    ap.ok = pubPolicy::sign(psm_, ap.pub.setContent(content.data(), content.size()));
+                } catch (...) { }   // (worker jobs mustn't throw)
+                m_sync.post([this, seq, ap = std::move(ap)]() mutable { asyncReady(seq, std::move(ap)); });
+            });
+    }
+
+    // build, sign & publish a pub using the worker pool (see pubAsync). A pub
+    // that can't be built or signed isn't published. If there's a PublishCb,
+    // it's called with the pub and false like a pub that timed out (if the
+    // pub has a name to identify it).
+    template<typename... Rest>
+    void publishAsync(std::span<const uint8_t> content, Rest&&... rest) {
+        pubAsync([this](Publication&& p, bool ok) { if (ok) m_sync.publish(std::move(p)); },
+                 content, std::forward<Rest>(rest)...);
+    }
+    template<typename... Rest>
+    void publishAsync(syncps::PublishCb&& pcb, std::span<const uint8_t> content, Rest&&... rest) {
+        pubAsync([this, pcb = std::move(pcb)](Publication&& p, bool ok) mutable {
+                    if (ok) m_sync.publish(std::move(p), std::move(pcb));
+                    else if (p.getName().size()) pcb(p, false);
+                 }, content, std::forward<Rest>(rest)...);
+    }
+    // number of pubAsync pubs that couldn't be built or signed
+    auto asyncFails() const noexcept { return asyncFails_; }
+
+    // pubAsync name args are used after the call returns so views become strings
+    template<typename T>
+    static auto ownArg(T&& a) {
+        if constexpr (std::is_convertible_v<T, std::string_view>) return std::string(std::string_view(a));
+        else return std::decay_t<T>(std::forward<T>(a));
+    }
+
+    // called on the io thread as each async pub is finished. Delivers all
+    // the pubs whose predecessors have been delivered.
+    void asyncReady(uint64_t seq, asyncPub&& ap) {
+        asyncDone_.emplace(seq, std::move(ap));
+        while (! asyncDone_.empty() && asyncDone_.begin()->first == asyncNext_) {
+            // remove the pub before its callback so a throw from it doesn't stall later pubs
+            auto [pub, cb, ok] = std::move(asyncDone_.begin()->second);
+            asyncDone_.erase(asyncDone_.begin());
+            ++asyncNext_;
+            if (! ok) ++asyncFails_;
+            cb(std::move(pub), ok);
+        }
+    }
+
     // set defaults to be used when constructing pub names
     template<typename... Rest>
     auto defaults(Rest&&... rest) { return bld_.defaults(std::forward<Rest>(rest)...); }
@@ -264,27 +501,55 @@ struct DCTmodel {
         }
     }
 
-    struct sPub : Publication {
-        using Publication::Publication;
-        sPub(const Publication& p) { *this = reinterpret_cast<const sPub&>(p); }
-        sPub(Publication&& p) { *this = std::move(reinterpret_cast<sPub&&>(p)); }
-
-        // accessors for name components of different types
-
-        size_t index(size_t s) const { return s;  }
-        size_t index(std::string_view s) const { return _s2i(s); }
-
-        std::string string(auto c) const { return getName()[index(c)].getValue().toRawStr(); }
+    // Handle for a pub name field: the name component index of one of the
+    // pub's tags. Getting it once with fieldIndex(tag) saves a tag lookup
+    // on every access.
+    struct pubField { size_t i; };
+    pubField fieldIndex(std::string_view tag) const { return {bld_.index(tag)}; }
+
+    // Name field accessors shared by sPub & pubView. A field can be given as
+    // a component index, a tag name (looked up on each call) or a pubField.
+    // For a pubField, string() returns a view of the component in the pub's
+    // name (valid as long as the pub) rather than a copy.
+    template<typename P>
+    struct fieldAccess {
+        const auto& pubName() const { return static_cast<const P&>(*this).getName(); }
+
+        static size_t index(size_t s) { return s; }
+        static size_t index(std::string_view s) { return _tm[s]; }
+        static size_t index(pubField f) { return f.i; }
+
+        std::string string(auto c) const { return pubName()[index(c)].getValue().toRawStr(); }
+        std::string_view string(pubField f) const {
+            const auto& v = pubName()[f.i].getValue();
+            return {(const char*)v.buf(), v.size()};
+        }
 
-        uint64_t number(auto c) const { return getName()[index(c)].toNumber(); }
+        uint64_t number(auto c) const { return pubName()[index(c)].toNumber(); }
         using ticks = std::chrono::microseconds; // period used in NDN timestamps
         using clock = std::chrono::sys_time<ticks>;
-        clock time(auto c) const { return clock(ticks(getName()[index(c)].toTimestampMicroseconds())); }
+        clock time(auto c) const { return clock(ticks(pubName()[index(c)].toTimestampMicroseconds())); }
         double timeDelta(auto c, std::chrono::system_clock::time_point tp = std::chrono::system_clock::now()) const {
                     return std::chrono::duration_cast<std::chrono::duration<double>>(tp - time(c)).count();
         }
         auto operator[](auto c) const { return string(c); }
     };
+
+    struct sPub : Publication, fieldAccess<sPub> {
+        using Publication::Publication;
+        sPub(const Publication& p) { *this = reinterpret_cast<const sPub&>(p); }
+        sPub(Publication&& p) { *this = std::move(reinterpret_cast<sPub&&>(p)); }
+    };
+
+    // field accessors for a pub without copying it
+    struct pubView : fieldAccess<pubView> {
+        const Publication& pub_;
+        pubView(const Publication& p) : pub_{p} { }
+        const auto& getName() const { return pub_.getName(); }
+        const auto& getContent() const { return pub_.getContent(); }
+        operator const Publication&() const { return pub_; }
+    };
 };
+using DCTmodel = DCTmodelT<>;
 
 #endif // DCTMODEL_HPP
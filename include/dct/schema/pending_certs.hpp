@@ -0,0 +1,201 @@
+#ifndef PENDING_CERTS_HPP
+#define PENDING_CERTS_HPP
+/*
+ * Bounded store for certs waiting on the arrival of their signing cert
+ *
+ * Copyright (C) 2021 Pollere, Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, see <https://www.gnu.org/licenses/>.
+ *  You may contact Pollere, Inc at info@pollere.net.
+ *
+ *  The DCT proof-of-concept is not intended as production code.
+ *  More information on DCT is available from info@pollere.net
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "dct_cert.hpp"
+
+// Certs can arrive before their signing cert so they are held here until it
+// shows up. Since the certs come from peers, the store is bounded: it holds at
+// most 'maxCerts' certs totaling at most 'maxBytes' of wire format, at most
+// 'maxPerSigner' of them waiting on the same signer, and none for longer than
+// 'maxAge'. Each cert has a priority (e.g., signing certs are worth more than
+// other certs since pubs can't validate without them). When a limit is hit
+// the oldest of the lowest priority certs (of the signer, for the per-signer
+// limit) is evicted since a cert whose signer hasn't shown up for a while is
+// the one least likely to ever validate.
+//
+// Cert distributors deliver each cert once so an evicted cert is gone unless
+// it's fetched again. Each evicted or expired cert is passed to 'evictCb_'
+// which should arrange that (see DistCert::refetch). A cert that's already
+// pending isn't added again.
+struct pendingCerts {
+    using clock = std::chrono::steady_clock;
+    using evictCb = std::function<void(const dctCert&)>;
+
+    struct entry {
+        thumbPrint signer;      // thumbprint of the signing cert being waited for
+        thumbPrint tp;          // this cert's thumbprint
+        dctCert cert;
+        size_t bytes;           // wire format size of cert
+        uint8_t prio;           // higher priority certs are evicted last
+        clock::time_point added;
+    };
+    using entries = std::list<entry>;           // in arrival order (oldest first)
+
+    struct stats {
+        size_t added{};         // certs added to the store
+        size_t duplicates{};    // certs not added since they were already pending
+        size_t resolved{};      // certs handed back when their signer arrived
+        size_t evicted{};       // certs evicted to stay within maxCerts/maxBytes
+        size_t signerEvicted{}; // certs evicted to stay within maxPerSigner
+        size_t expired{};       // certs evicted for exceeding maxAge
+        size_t maxDepth{};      // high water mark of size()
+        size_t maxBytes{};      // high water mark of bytes()
+    };
+
+    size_t maxCerts_;
+    size_t maxPerSigner_;
+    size_t maxBytes_;
+    clock::duration maxAge_;
+
+    entries order_{};
+    std::unordered_map<thumbPrint,std::vector<entries::iterator>> bySigner_{};
+    std::unordered_set<thumbPrint> certs_{};    // thumbprints of pending certs
+    size_t bytes_{};
+    stats stats_{};
+    evictCb evictCb_{[](const dctCert&) {}};
+
+    pendingCerts(size_t maxCerts = 128, size_t maxPerSigner = 8, size_t maxBytes = 256*1024,
+                 clock::duration maxAge = std::chrono::minutes(2)) :
+        maxCerts_{std::max(maxCerts, size_t(1))}, maxPerSigner_{std::max(maxPerSigner, size_t(1))},
+        maxBytes_{maxBytes}, maxAge_{maxAge} { }
+
+    auto size() const noexcept { return order_.size(); }
+    auto empty() const noexcept { return order_.empty(); }
+    auto bytes() const noexcept { return bytes_; }
+    auto signers() const noexcept { return bySigner_.size(); }
+    const auto& getStats() const noexcept { return stats_; }
+
+    // number of certs waiting on 'signer'
+    size_t depth(const thumbPrint& signer) const {
+        const auto s = bySigner_.find(signer);
+        return s == bySigner_.end()? 0 : s->second.size();
+    }
+
+    // add 'cert' (with thumbprint 'tp' and priority 'prio') to wait for its
+    // signer 'signer'. Returns false if it was already pending.
+    bool add(const thumbPrint& signer, const thumbPrint& tp, const dctCert& cert, uint8_t prio = 0,
+             clock::time_point now = clock::now()) {
+        expire(now);
+        if (certs_.contains(tp)) {
+            ++stats_.duplicates;
+            return false;
+        }
+        const size_t sz = cert.wireEncode().size();
+
+        // make room for the cert in its signer's bucket then in the store
+        if (auto s = bySigner_.find(signer); s != bySigner_.end() && s->second.size() >= maxPerSigner_) {
+            evict(*std::min_element(s->second.begin(), s->second.end(), olderLowerPrio));
+            ++stats_.signerEvicted;
+        }
+        while (! order_.empty() && (order_.size() >= maxCerts_ || bytes_ + sz > maxBytes_)) {
+            auto v = order_.begin();
+            for (auto e = order_.begin(); e != order_.end(); ++e) if (e->prio < v->prio) v = e;
+            evict(v);
+            ++stats_.evicted;
+        }
+        auto e = order_.insert(order_.end(), entry{signer, tp, cert, sz, prio, now});
+        bySigner_[signer].emplace_back(e);
+        certs_.emplace(tp);
+        bytes_ += sz;
+
+        ++stats_.added;
+        stats_.maxDepth = std::max(stats_.maxDepth, order_.size());
+        stats_.maxBytes = std::max(stats_.maxBytes, bytes_);
+        return true;
+    }
+
+    // remove and return the certs waiting on 'signer' (oldest first)
+    std::vector<dctCert> take(const thumbPrint& signer, clock::time_point now = clock::now()) {
+        expire(now);
+        std::vector<dctCert> res{};
+        auto s = bySigner_.find(signer);
+        if (s == bySigner_.end()) return res;
+
+        auto waiting = std::move(s->second);
+        bySigner_.erase(s);
+        res.reserve(waiting.size());
+        for (auto e : waiting) {
+            certs_.erase(e->tp);
+            bytes_ -= e->bytes;
+            res.emplace_back(std::move(e->cert));
+            order_.erase(e);
+        }
+        stats_.resolved += res.size();
+        return res;
+    }
+
+    // remove and return all the certs (oldest first)
+    std::vector<dctCert> takeAll(clock::time_point now = clock::now()) {
+        expire(now);
+        std::vector<dctCert> res{};
+        res.reserve(order_.size());
+        for (auto& e : order_) res.emplace_back(std::move(e.cert));
+        stats_.resolved += res.size();
+        order_.clear();
+        bySigner_.clear();
+        certs_.clear();
+        bytes_ = 0;
+        return res;
+    }
+
+    // evict certs that have been waiting longer than maxAge
+    void expire(clock::time_point now = clock::now()) {
+        while (! order_.empty() && now - order_.front().added > maxAge_) {
+            evict(order_.begin());
+            ++stats_.expired;
+        }
+    }
+
+    // true if 'a' should be evicted before 'b' (entries of a list are in age order)
+    static bool olderLowerPrio(entries::iterator a, entries::iterator b) {
+        return a->prio < b->prio || (a->prio == b->prio && a->added < b->added);
+    }
+
+    // remove a cert from the store and hand it to evictCb_
+    void evict(entries::iterator e) {
+        auto c = std::move(e->cert);
+        erase(e);
+        evictCb_(c);
+    }
+
+    void erase(entries::iterator e) {
+        auto s = bySigner_.find(e->signer);
+        auto& v = s->second;
+        v.erase(std::find(v.begin(), v.end(), e));
+        if (v.empty()) bySigner_.erase(s);
+        certs_.erase(e->tp);
+        bytes_ -= e->bytes;
+        order_.erase(e);
+    }
+};
+
+#endif // PENDING_CERTS_HPP
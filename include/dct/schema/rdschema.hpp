@@ -25,10 +25,15 @@
 
 #include <bit>
 #include <bitset>
+#include <cstring>
 #include <iostream>
 #include <istream>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <span>
 #include <type_traits>
+#include <vector>
 #include <version>
 #include "bschema.hpp"
 #include "dct/format.hpp"
@@ -39,9 +44,20 @@ using parmSet = std::bitset<sizeof(parmBM)*8>;
 using chainSet = std::bitset<sizeof(chainBM)*8>;
 using discSet = std::bitset<sizeof(discBM)*8>;
 
+// The reader works directly on the schema's bytes (e.g., the content of
+// its cert). The bSchema it produces keeps views into them so it takes
+// shared ownership of the buffer rather than copying.
 template<bool rsdebug = false>
 struct rdSchema {
-    explicit rdSchema(std::istream& is) : is_(is), remaining_{65535} {}
+    using schemaBuf = bSchema::schemaBuf;
+
+    explicit rdSchema(schemaBuf buf) : remaining_{65535} {
+        if (buf) in_ = *buf;
+        bs_.buf_ = std::move(buf);
+    }
+    explicit rdSchema(std::vector<uint8_t>&& buf) : rdSchema(std::make_shared<const std::vector<uint8_t>>(std::move(buf))) {}
+    explicit rdSchema(std::istream& is) :
+        rdSchema(std::vector<uint8_t>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>())) {}
 
     // ------ helper routines start here ------
     template <typename... T>
@@ -81,9 +97,17 @@ struct rdSchema {
         if (len > remaining_) throw schema_error("tlv bigger than its container");
         remaining_ -= len;
     }
+    int pos() const noexcept { return pos_; }
+    // return a view of the next 'len' bytes of the schema
+    std::span<const uint8_t> getBytes(int len) {
+        if (len < 0 || size_t(len) > in_.size() - size_t(pos_)) throw schema_error("schema truncated");
+        auto res = in_.subspan(pos_, len);
+        pos_ += len;
+        return res;
+    }
     uint8_t getByte() {
         decrRemaining();
-        return (uint8_t)is_.get();
+        return getBytes(1)[0];
     }
     static constexpr uint8_t extra_bytes_code{253};
     int decodeLen() {
@@ -112,51 +136,52 @@ struct rdSchema {
     // ------ template routines to read either fixed or variable length ------
     // ------ items while maintaning an appropriate level of paranoia   ------
 
-    // read one vector or scalar item.
+    // read one vector item (a length followed by that many items).
     template<typename Tin,typename Tout=typename std::decay_t<Tin>::value_type>
     Tout getItem(int last) {
-        // test if Tout is a vector (or string)
-        constexpr bool is_vec = requires(const Tout& t) { t.data(); };
-        if constexpr (is_vec) {
-            // read a length followed by that many component tokens.
-            auto len = decodeLen();
-            if (len > last - is_.tellg()) throw schema_error("vec too long");
-            using iType = typename std::decay_t<Tout>::value_type;
-            if (len % sizeof(iType) != 0) throw schema_error("length not multiple of item size");
-            Tout dat(len / sizeof(iType));
-            if (len > 0) is_.read((char*)(&dat[0]), len);
-            return dat;
-        } else {
-            if (last - int(sizeof(Tout)) < is_.tellg()) throw schema_error("item truncated");
-            Tout dat;
-            is_.read((char*)(&dat), sizeof(Tout));
-            return dat;
-        }
+        auto len = decodeLen();
+        if (len > last - pos()) throw schema_error("vec too long");
+        using iType = typename std::decay_t<Tout>::value_type;
+        if (len % sizeof(iType) != 0) throw schema_error("length not multiple of item size");
+        Tout dat(len / sizeof(iType));
+        if (len > 0) std::memcpy(dat.data(), getBytes(len).data(), len);
+        return dat;
     }
 
     // read TLV 'tlv' which contains a 'vector' of type 'Tout' items.
     template<typename Tout, class Getter>
     void readVec(sTLV tlv, std::vector<Tout>& vec, Getter getItem) {
-        int last = checkHDR(tlv) + is_.tellg();
-        while (is_.tellg() < last) {
+        int last = checkHDR(tlv) + pos();
+        while (pos() < last) {
             vec.emplace_back(getItem(last));
         }
     }
 
+    // TLV 'tlv' contains a packed array of fixed size 'Tout' items. Make
+    // 'view' refer to them (in place) then call 'chkItem' on each.
+    template<typename Tout, class Checker>
+    void readView(sTLV tlv, itemView<Tout>& view, Checker chkItem) {
+        int len = checkHDR(tlv);
+        if (len % sizeof(Tout) != 0) throw schema_error("item truncated");
+        view = itemView<Tout>{getBytes(len).data(), len / sizeof(Tout)};
+        for (size_t i = 0; i < view.size(); ++i) chkItem(i, view[i]);
+    }
+
     // ------ routines to read and validate schema sections start here ------
 
     void readStr() {
         // the string table (stab) is a single array of characters.
         int len = checkHDR(sTLV::str);
         decrRemaining(len);
-        bs_.stab_.insert(0, len + 1, char(0));
-        is_.read(&bs_.stab_[0], len);
+        auto str = getBytes(len);
+        bs_.stab_ = std::string_view((const char*)str.data(), str.size());
     }
     void readTok() {
         // tokens are a (variable length encoded) offset followed by a one byte length. The entire token
         // must be within the stab.  They are converted to a vector of stab string_views and a map
         // from a string to a token index.
         auto& vec = bs_.tok_;
+        bs_.tm_.reserve(maxTok);
         readVec(sTLV::tok, vec,
             [this,&vec,stablen=bs_.stab_.size()](int /*last*/) {
                 size_t off = decodeLen();
@@ -253,11 +278,9 @@ struct rdSchema {
         // Each discriminator is a 5-tuple containing the information
         // needed to build and validate one variant of a publication.
         dprint("discrim\n");
-        auto& vec = bs_.discrim_;
-        readVec(sTLV::disc, vec,
-            [this,&vec](int last) {
-                auto n = getItem<decltype(vec)>(last);
-                dprint(" {}: {}\n", vec.size(), n);
+        readView(sTLV::disc, bs_.discrim_,
+            [this](size_t i, const tDiscrim& n) {
+                dprint(" {}: {}\n", i, n);
                 const auto& [chain,tmplt,comp,vlist,cor] = n;
                 for (auto chn = chain; chn != 0; ) {
                     size_t c = std::countr_zero(chn);
@@ -280,15 +303,12 @@ struct rdSchema {
                 // 'cor' is an index of the cert chain component correspondences that must hold
                 // for a publication with this discrim.
                 if (cor >= bs_.cor_.size() && cor > 0) throw schema_error(format("invalid discrim cor index {}", cor));
-                return n;
             });
     }
     void readPub() {
         // Each pub is a 4-tuple containing the information needed to build and validate all its variants.
-        auto& vec = bs_.pub_;
-        readVec(sTLV::pub, vec,
-            [this](int last) {
-                auto n = getItem<decltype(vec)>(last);
+        readView(sTLV::pub, bs_.pub_,
+            [this](size_t, const tPub& n) {
                 const auto& [param,disc,pub,tagi] = n;
                 if (pub >= bs_.tok_.size()) throw schema_error("invalid pub tok index");
                 if (tagi >= bs_.tag_.size()) throw schema_error("invalid pub tag index");
@@ -313,7 +333,6 @@ struct rdSchema {
                     if (p >= bs_.tag_[tagi].size()) throw schema_error("invalid pub param index");
                     par &=~ 1u << p;
                 }
-                return n;
             });
     }
     const bName& corName(const bName& tmplt, chainidx c, certidx cert, compidx comp) {
@@ -398,7 +417,8 @@ struct rdSchema {
         return bs_;
     }
 
-    std::istream& is_;
+    std::span<const uint8_t> in_;   // the schema's bytes
+    int pos_{};                     // offset of next byte to read
     int remaining_{};
     bSchema bs_{};
 };
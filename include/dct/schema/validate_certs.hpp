@@ -74,25 +74,24 @@ static inline int matchesAny(const bSchema& bs, const certName& cert) {
     return -1;
 }
 
-// check if 'cv' matchs all the certs in schema chain sc
-static inline bool matchesAll(const bSchema& bs, const certVec& cv, const bChain& sc) {
+// check if signing chain 'cv' matchs all the certs in schema chain sc
+static inline bool matchesAll(const bSchema& bs, const chainRefs& cv, const bChain& sc) {
     if (cv.size() != sc.size()) return false;
-    for (size_t n = cv.size(), i=0; i < n; i++) if (! matches(bs, cv[i],  sc[i])) return false;
+    for (size_t n = cv.size(), i=0; i < n; i++) if (! matches(bs, cv[i]->getName(),  sc[i])) return false;
     return true;
 }
 
-// check if 'cert' matchs one of the schema's pub signing certs
-static inline int matchesChain(const bSchema& bs, const certStore& cs, const dctCert& cert) {
-    auto chn = cs.chainNames(cert);
+// check if signing chain 'chn' matchs one of the schema's pub signing chains
+static inline int matchesChain(const bSchema& bs, const chainRefs& chn) {
     for (int n = bs.chain_.size(), i=0; i < n; i++) if (matchesAll(bs, chn, bs.chain_[i])) return i;
     return -1;
 }
 
 // check that schema 'bs' cert name component correspondences indexed by 'ci'
-// hold for vector of cert names 'cv'.
-static bool validateChainCors(const bSchema& bs, const certVec& cv, coridx ci) {
+// hold for signing chain 'cv'.
+static bool validateChainCors(const bSchema& bs, const chainRefs& cv, coridx ci) {
     for (const auto [n1, c1, n2, c2] : bs.cor_[ci]) {
-        if (n1 > 0 && cv[n1-1][c1] != cv[n2-1][c2]) return false;
+        if (n1 > 0 && cv[n1-1]->getName()[c1] != cv[n2-1]->getName()[c2]) return false;
     }
     return true;
 }
@@ -100,7 +99,8 @@ static bool validateChainCors(const bSchema& bs, const certVec& cv, coridx ci) {
 // validate the entire signing chain of 'cert' against schema 'bs'. 'cert' must be a signing cert.
 // 'cert' doesn't need to be in certStore 'cs' but all the other certs of the chain must be.
 static inline int validateChain(const bSchema& bs, const certStore& cs, const dctCert& cert) {
-    auto c = matchesChain(bs, cs, cert);
+    const auto chain = cs.chain(cert);
+    auto c = matchesChain(bs, chain);
     if (c < 0) return c; // chain doesn't match any schema chain
 
     // if schema has any cors, check cors for all the discrims that include this chain
@@ -109,7 +109,7 @@ static inline int validateChain(const bSchema& bs, const certStore& cs, const dc
     for (const auto& d : bs.discrim_) {
         if ((d.cbm & chn) == 0) continue;           // not this chain
         if (bs.cor_[d.cor].size() == 0) continue;   // no cors
-        if (! validateChainCors(bs, cs.chainNames(cert), d.cor)) return -1;
+        if (! validateChainCors(bs, chain, d.cor)) return -1;
     }
     return c;
 }
@@ -24,7 +24,9 @@
  */
 
 #include <algorithm>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <string_view>
 #include <set>
 #include <unordered_map>
@@ -37,14 +39,31 @@
 #include "dct/distributors/dist_cert.hpp"
 #include "dct/distributors/dist_gkey.hpp"
 
+// A pubValidator checks that a pub name matches one of the pub templates
+// associated with its signer's signing chain. At construction the templates
+// are compiled into a matcher so validation is one pass over the name no
+// matter how many templates there are: every string the templates can match
+// (literals, cor values and discriminator values) is interned as a small
+// token id and, for each name component position, 'accept_' holds the set
+// (bitmask) of templates whose component there accepts each token id. Names
+// are matched by intersecting the masks for their components' ids starting
+// from the templates of the right length. Schemas with more pub templates
+// than bits in a tmask use the template-at-a-time matcher instead.
 struct pubValidator {
+    using tmask = uint64_t;
+    static constexpr size_t maxDfaTmplts = sizeof(tmask) * 8;
+
     std::vector<pTmplt> ptmplts_;
-    std::unordered_map<bTok,bComp> ptm_;    // pub-specific token map
+    tokMap<bComp> ptm_;                     // pub-specific token map
     std::vector<bTok> ptok_;                // pub-specific tokens
-    std::vector<std::string> pstab_;        // pub-specific string table
- 
-    pubValidator(std::vector<pTmplt>&& pt, std::unordered_map<bTok,bComp>&& ptm,
-                 std::vector<bTok>&& ptok, std::vector<std::string>&& pstab) :
+    std::deque<std::string> pstab_;         // pub-specific string table
+    tokMap<uint16_t> tokId_{};              // interned template strings
+    uint16_t nid_{};                        // # token ids (including 'other')
+    std::vector<tmask> byLen_{};            // templates with each name length
+    std::vector<tmask> accept_{};           // [comp position * nid_ + token id]
+
+    pubValidator(const bSchema& bs, std::vector<pTmplt>&& pt, tokMap<bComp>&& ptm,
+                 std::vector<bTok>&& ptok, std::deque<std::string>&& pstab) :
                     ptmplts_{std::move(pt)}, ptm_{std::move(ptm)}, ptok_{std::move(ptok)}, pstab_{std::move(pstab)} {
         // specialize templates for validation (vs construction)
         for (auto& pt : ptmplts_) {
@@ -55,6 +74,7 @@ struct pubValidator {
                 if (isParam(c) || isCall(c)) c = SC_ANON;
             }
         }
+        if (ptmplts_.size() <= maxDfaTmplts) compile(bs);
     }
 
     using Name = ndn_ind::Name;
@@ -66,6 +86,60 @@ struct pubValidator {
         return std::string_view((const char*)b.data(), b.size());
     }
 
+    static bool discriminated(const pTmplt& pt) noexcept { return pt.vs_.to_ulong() > 1ul; }
+
+    // the string template component 'ptc' must match (if it's a literal)
+    std::string_view compStr(const bSchema& bs, bComp ptc) const noexcept {
+        if (isAnon(ptc)) return {};
+        if (isLit(ptc)) return bs.tok_[ptc];
+        if (isIndex(ptc)) return ptok_[typeValue(ptc)];
+        return {};
+    }
+
+    // Build the matcher tables. Token id nid_-1 is 'other' (any string that
+    // isn't in the templates) which only anonymous components accept.
+    void compile(const bSchema& bs) {
+        // (strings are either in the schema or our pstab_ so they outlive tokId_)
+        auto intern = [this](bTok s) { tokId_.emplace(s, tokId_.size()); };
+        size_t maxLen = 0;
+        for (const auto& pt : ptmplts_) {
+            maxLen = std::max(maxLen, pt.tmplt_.size());
+            for (auto c : pt.tmplt_) if (! isAnon(c) && (isLit(c) || isIndex(c))) intern(compStr(bs, c));
+            if (discriminated(pt)) {
+                for (size_t t = 0; t < pt.vs_.size() && t < bs.tok_.size(); ++t) if (pt.vs_[t]) intern(bs.tok_[t]);
+            }
+        }
+        nid_ = tokId_.size() + 1;
+        std::vector<bTok> idStr(nid_);
+        for (const auto& [str, id] : tokId_.ent_) idStr[id] = str;
+
+        byLen_.assign(maxLen + 1, 0);
+        accept_.assign(maxLen * nid_, 0);
+        for (size_t i = 0; i < ptmplts_.size(); ++i) {
+            const auto& pt = ptmplts_[i];
+            const tmask bit = tmask(1) << i;
+            byLen_[pt.tmplt_.size()] |= bit;
+            for (size_t c = 0; c < pt.tmplt_.size(); ++c) {
+                const auto ptc = pt.tmplt_[c];
+                const bool disc = discriminated(pt) && c == pt.dpar_;
+                for (uint16_t id = 0; id < nid_; ++id) {
+                    const bool other = id == nid_ - 1;
+                    // the template component must accept the string ...
+                    bool ok = isAnon(ptc) || (! other && (isLit(ptc) || isIndex(ptc)) && idStr[id] == compStr(bs, ptc));
+                    // ... and, if this is the discriminator, it must be in the value set
+                    if (ok && disc) {
+                        ok = false;
+                        if (! other) {
+                            if (auto v = bs.tm_.find(idStr[id]); v != bs.tm_.end() && v->second < pt.vs_.size())
+                                ok = pt.vs_[v->second];
+                        }
+                    }
+                    if (ok) accept_[c * nid_ + id] |= bit;
+                }
+            }
+        }
+    }
+
     // Map 'nm' component 'c' to a template token number.
     // Returns the token number if found, maxTok otherwise.
     bComp compToTok(const bSchema& bs, std::string_view pval) const noexcept {
@@ -86,20 +160,35 @@ struct pubValidator {
     }
     // check that everything in the template matches its correponding name component
     bool matchComps(const bSchema& bs, const Name& nm, const pTmplt& pt) const noexcept {
+        if (nm.size() != pt.tmplt_.size()) return false;
         for (auto c = 0u; c < nm.size(); c++) if (!matchCompVal(bs, nm[c], pt.tmplt_[c])) return false;
         return true;
     }
-    // check that Name 'nm' matches one of our pub templates
-    bool matchTmplt(const bSchema& bs, const Name& nm) const noexcept {
+    // check that Name 'nm' matches one of our pub templates (one template at a time)
+    bool matchTmpltScan(const bSchema& bs, const Name& nm) const noexcept {
         for (const auto& pt : ptmplts_) {
+            if (nm.size() != pt.tmplt_.size()) continue;
             // if template has a discriminator check it first
-            if (pt.vs_.to_ulong() > 1ul) {
-                if (auto t = compToTok(bs, to_sv(nm[pt.dpar_])); t == maxTok || !pt.vs_[t]) continue;
+            if (discriminated(pt)) {
+                if (auto t = compToTok(bs, to_sv(nm[pt.dpar_])); t >= pt.vs_.size() || !pt.vs_[t]) continue;
             }
             if (matchComps(bs, nm, pt)) return true;
         }
         return false;
     }
+    // check that Name 'nm' matches one of our pub templates
+    bool matchTmplt(const bSchema& bs, const Name& nm) const noexcept {
+        if (ptmplts_.size() > maxDfaTmplts) return matchTmpltScan(bs, nm);
+
+        const size_t n = nm.size();
+        if (n >= byLen_.size()) return false;
+        auto live = byLen_[n];
+        for (size_t c = 0; c < n && live; ++c) {
+            const auto t = tokId_.find(to_sv(nm[c]));
+            live &= accept_[c * nid_ + (t != tokId_.end()? t->second : nid_ - 1)];
+        }
+        return live != 0;
+    }
 };
 
 // syncps validates each arriving publication using the 'validate' method of
@@ -127,31 +216,42 @@ struct pubValidator {
 // SigMgrSchema constructor below so it can find the appropriate validator
 // for each arriving Pub.
 
-using tpToValidator = std::unordered_map<thumbPrint,pubValidator>;
+// Validators depend only on the shape of the signer's chain (see
+// pubBldr::chainShape) so signers with the same shape share one.
+using tpToValidator = std::unordered_map<thumbPrint,std::shared_ptr<const pubValidator>>;
 
-struct SigMgrSchema final : SigMgr {
-    SigMgr& pubsm_;
+// 'PubSM' is the type of the pub sigmgr doing the crypto validation. The
+// default (SigMgr) is dynamically dispatched; a concrete sigmgr type lets the
+// crypto check be bound at compile time (see sigmgrPolicy in sigmgr.hpp).
+template<typename PubSM = SigMgr>
+struct SigMgrSchemaT final : SigMgr {
+    using policy = sigmgrPolicy<PubSM>;
+    using pubFilter = bool (*)(const ndn_ind::Name&);
+    PubSM& pubsm_;
     const bSchema& bs_;
     const tpToValidator& pv_;
+    pubFilter prefilter_{};     // cheap structural reject run before the crypto (if set)
 
-    SigMgrSchema(SigMgr& pubsm, const bSchema& bs, const tpToValidator& pv) :
-        SigMgr(pubsm.type(), pubsm.getSigInfo()), pubsm_{pubsm}, bs_{bs}, pv_{pv} { }
+    SigMgrSchemaT(PubSM& pubsm, const bSchema& bs, const tpToValidator& pv) :
+        SigMgr(policy::ref(pubsm).type(), policy::ref(pubsm).getSigInfo()), pubsm_{pubsm}, bs_{bs}, pv_{pv} { }
 
     bool validate(const ndn_ind::Data& data) override final {
+        if (prefilter_ && ! prefilter_(data.getName())) return false;
         // cryptographically validate 'data'
-        if (! pubsm_.validate(data)) {
+        if (! policy::validate(pubsm_, data)) {
             //print("invalid sig {}\n", data.getName().toUri());
             return false;
         }
         // structurally validate 'data'
         try {
             const auto& pubval = pv_.at(dctCert::getKeyLoc(data));
-            auto valid = pubval.matchTmplt(bs_, data.getName());
+            auto valid = pubval->matchTmplt(bs_, data.getName());
             //if (!valid) print("invalid str {}\n", data.getName().toUri());
             return valid;
         } catch (std::exception&) {}
         return false;
     }
 };
+using SigMgrSchema = SigMgrSchemaT<>;
 
 #endif // VALIDATE_PUB_HPP
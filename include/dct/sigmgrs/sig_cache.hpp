@@ -0,0 +1,103 @@
+#ifndef SIGCACHE_HPP
+#define SIGCACHE_HPP
+/*
+ * Verified-signature cache
+ *
+ * Copyright (C) 2020 Pollere, Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, see <https://www.gnu.org/licenses/>.
+ *  You may contact Pollere, Inc at info@pollere.net.
+ *
+ *  The DCT proof-of-concept is not intended as production code.
+ *  More information on DCT is available from info@pollere.net
+ */
+
+/*
+ * sigCache remembers packets whose signature has already been verified so
+ * that duplicate arrivals (e.g., the same pub from several concurrent sync
+ * responders or a cert that's re-checked while resolving pending certs)
+ * don't repeat the public key crypto.
+ *
+ * Entries are a 16 byte BLAKE2b digest of the packet's entire wire encoding
+ * (so it covers both the signed portion and the signature) and the public key
+ * it verified against. Only successful verifications are recorded. The cache
+ * is bounded by entry count and entries are aged out after 'maxAge' (which
+ * defaults to the max publication lifetime plus clock skew allowance since
+ * a duplicate can't usefully arrive later than that). Entries are kept in
+ * arrival order so eviction of both the oldest and the expired is FIFO.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <span>
+#include <unordered_set>
+
+extern "C" {
+    #include <sodium.h>
+};
+
+struct sigCache {
+    using digest = std::array<uint8_t,16>;
+    using clock = std::chrono::steady_clock;
+    struct dHash {
+        // digest is already uniformly distributed so use its leading bytes
+        size_t operator()(const digest& d) const noexcept { size_t h; std::memcpy(&h, d.data(), sizeof(h)); return h; }
+    };
+
+    size_t maxEntries_;
+    clock::duration maxAge_;
+    std::unordered_set<digest,dHash> set_{};
+    std::deque<std::pair<clock::time_point,digest>> fifo_{};
+
+    sigCache(size_t maxEntries = 1024, clock::duration maxAge = std::chrono::seconds(5)) :
+        maxEntries_{maxEntries}, maxAge_{maxAge} { }
+
+    static digest hash(std::span<const uint8_t> wire, std::span<const uint8_t> pk) noexcept {
+        digest d;
+        crypto_generichash_state st;
+        crypto_generichash_init(&st, nullptr, 0, d.size());
+        crypto_generichash_update(&st, pk.data(), pk.size());
+        crypto_generichash_update(&st, wire.data(), wire.size());
+        crypto_generichash_final(&st, d.data(), d.size());
+        return d;
+    }
+
+    // drop expired entries and the oldest entries beyond maxEntries_
+    void age(clock::time_point now) {
+        while (! fifo_.empty() && (fifo_.size() > maxEntries_ || now - fifo_.front().first > maxAge_)) {
+            set_.erase(fifo_.front().second);
+            fifo_.pop_front();
+        }
+    }
+
+    bool contains(const digest& d) {
+        if (set_.empty()) return false;
+        age(clock::now());
+        return set_.contains(d);
+    }
+
+    void insert(const digest& d) {
+        if (maxEntries_ == 0) return;
+        auto now = clock::now();
+        if (set_.insert(d).second) fifo_.emplace_back(now, d);
+        age(now);
+    }
+
+    void clear() { set_.clear(); fifo_.clear(); }
+    auto size() const noexcept { return set_.size(); }
+};
+
+#endif // SIGCACHE_HPP
@@ -30,16 +30,21 @@
  */
 
 /*
- * Five signature-managers and using SIGNER_TYPE:
+ * Seven signature-managers and using SIGNER_TYPE:
  *  0x00 SHA256
  *  0x07 AEAD
  *  0x08 EdDSA
  *  0x09 RFC7693
  *  0x0a NULL
+ *  0x0b AEADGCM (AES-256-GCM version of AEAD)
+ *  0x0c MAC (keyed BLAKE2b using the AEAD group key)
+ *  0x0d EdDSAMerkle (batch of pubs signed by SigMgrEdDSA over a Merkle root)
  * Note that NULL is used to bypass signing for dctCerts which are already
  * signed and should not be used otherwise.
  */
 
+#include <span>
+#include <type_traits>
 #include <ndn-ind/data.hpp>
 #include <ndn-ind/generic-signature.hpp>
 
@@ -71,6 +76,9 @@ struct SigMgr {
     static constexpr SigType stEdDSA = 8;
     static constexpr SigType stRFC7693 = 9;
     static constexpr SigType stNULL = 10;
+    static constexpr SigType stAEADGCM = 11;
+    static constexpr SigType stMAC = 12;
+    static constexpr SigType stEdDSAMerkle = 13;
 
     SigMgr(SigType typ, SigInfo&& si = {}) : m_type{typ}, m_sigInfo{std::move(si)} {}
     bool sign(ndn_ind::Data& d) { return sign(d, m_sigInfo, m_signingKey); };
@@ -83,6 +91,15 @@ struct SigMgr {
     virtual void updateSigningKey(const keyVal&, const dct_Cert&) {};
     virtual bool needsKey() const noexcept { return 1; };
 
+    // Sign a batch of locally produced Data. Sigmgrs that can cover a batch
+    // with one signature (batchSigning() is true) override this. Otherwise
+    // each item is signed individually.
+    virtual bool signBatch(std::span<ndn_ind::Data> batch) {
+        for (auto& d : batch) if (! sign(d)) return false;
+        return true;
+    }
+    virtual bool batchSigning() const noexcept { return false; }
+
     // if validate requires public keys of publishers, m_keyCb returns by keylocator
     void setKeyCb(KeyCb&& kcb) { m_keyCb = std::move(kcb);}
 
@@ -93,13 +110,43 @@ struct SigMgr {
     SigType type() const noexcept { return m_type; };
     SigInfo getSigInfo() const noexcept { return m_sigInfo; }
 
-    // sign() helper method
-    auto setupSignature(ndn_ind::Data& data, const SigInfo& si) const {
+    // sign() helper method. If 'sigLen' is non-zero, the SignatureValue is
+    // set to that many zero bytes so the returned wire encoding has the
+    // final layout and the signature can be filled in without re-encoding.
+    auto setupSignature(ndn_ind::Data& data, const SigInfo& si, size_t sigLen = 0) const {
         auto sigInfo = ndn_ind::GenericSignature();
         sigInfo.setSignatureInfoEncoding(si);
+        if (sigLen) sigInfo.setSignature(std::vector<uint8_t>(sigLen));
         data.setSignature(sigInfo);
         return data.wireEncode();
     }
 };
 
+/*
+ * Sigmgr 'policy' used by code that's templated on the sigmgr type it
+ * holds (SyncPubsubT, SigMgrSchemaT, DCTmodelT). When 'SM' is one of the
+ * concrete (final) sigmgrs every call below is bound at compile time and
+ * can be inlined. When 'SM' is SigMgr (the default for all the templates)
+ * they're the usual virtual calls.
+ */
+template<typename SM>
+struct sigmgrPolicy {
+    static SigMgr& ref(SM& sm) noexcept { return sm; }
+
+    static bool sign(SM& sm, ndn_ind::Data& d) { return sm.sign(d, sm.m_sigInfo, sm.m_signingKey); }
+    static bool signBatch(SM& sm, std::span<ndn_ind::Data> b) { return sm.signBatch(b); }
+    static bool validate(SM& sm, const ndn_ind::Data& d) { return sm.validate(d); }
+    static bool validate(SM& sm, const ndn_ind::Data& d, const dct_Cert& c) { return sm.validate(d, c); }
+    static bool validateDecrypt(SM& sm, ndn_ind::Data& d) {
+        // a final sigmgr that doesn't override validateDecrypt gets the base
+        // class version which just calls validate() so call that directly.
+        if constexpr (std::is_final_v<SM> &&
+                      std::is_same_v<decltype(&SM::validateDecrypt), bool (SigMgr::*)(ndn_ind::Data&)>) {
+            return sm.validate(d);
+        } else {
+            return sm.validateDecrypt(d);
+        }
+    }
+};
+
 #endif //SIGMGR_HPP
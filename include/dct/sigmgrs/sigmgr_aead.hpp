@@ -45,26 +45,53 @@
  * whose lenth is equal to the message length. Also computes a tag that
  * authenticates the ciphertext plus the ad of adlen and puts the tag
  * into mac of length of crypto_aead_chacha20poly1305_IETF_ABYTES bytes
+ *
+ * SigMgrAEAD also handles signature type AEADGCM which uses AES-256-GCM
+ * (libsodium's crypto_aead_aes256gcm) in place of ChaCha20-Poly1305. It has the
+ * same key, nonce and mac sizes so the packet layout is unchanged. The
+ * libsodium implementation requires AES-NI and PCLMUL so availability is checked
+ * at runtime. Every member of a collection has to be able to decrypt its packets
+ * so there's no silent fallback: constructing an AEADGCM sigmgr on a machine
+ * without the hardware throws (a schema should only select AEADGCM when all its
+ * members have it). Validation dispatches on the packet's signature type so
+ * nodes with the hardware accept both types.
  */
 
 /*
- * The SignatureInfo content is fixed 5 bytes for this signing method:
+ * The SignatureInfo content is fixed 13 bytes for this signing method:
  *  0x16 (SigInfo) <number of bytes to follow in SigInfo>
  *  0x1b (SignatureType) <number of bytes to follow that give signatureType>
- *  0x07 (signed by AEAD key)
+ *  0x07 (signed by AEAD key) or 0x0b (signed by AEADGCM key)
+ *  0x1c (KeyLocator) 0x06 0x1d (KeyDigest) 0x04 followed by
+ *   <4 byte key id: low order 4 bytes (little-endian) of the group key's creation time>
+ *
+ * The key id lets a receiver pick the group key directly rather than trying
+ * each key it holds (a rekey would otherwise cost two decryptions for every
+ * packet still using the old key). Since the SigInfo is part of the AD, the
+ * key id is authenticated. Up to maxKeys keys are kept so rekey windows can
+ * overlap.
+ *
  *  Followed by:
  *  0x17 (SignatureValueType) <number of bytes in signature> <signature bytes>
  */
 
+#include <algorithm>
 #include <array>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include "sigmgr.hpp"
 
 using keyVal = std::vector<uint8_t>;
 const uint32_t aeadkeySize = crypto_aead_chacha20poly1305_IETF_KEYBYTES;
 const uint32_t nonceSize = crypto_aead_chacha20poly1305_IETF_NPUBBYTES;
+static_assert(crypto_aead_aes256gcm_KEYBYTES == aeadkeySize &&
+              crypto_aead_aes256gcm_NPUBBYTES == nonceSize &&
+              crypto_aead_aes256gcm_ABYTES == crypto_aead_chacha20poly1305_IETF_ABYTES,
+              "AEAD and AEADGCM must have the same key, nonce & mac sizes");
 
 struct keyRecord {
-    keyRecord (keyVal k, uint64_t kts)
+    keyRecord (keyVal k, uint64_t kts) : id{uint32_t(kts)}
     {
         key = k;
         //convert key timestamp to array of uint8_t
@@ -72,68 +99,103 @@ struct keyRecord {
             iv.push_back((unsigned char) (kts >> (i*8)));
         }
     }
+    uint32_t id;    // key id carried in packets' SigInfo
     keyVal key;
     std::vector<uint8_t> iv;
-    //maybe add a fingerprint of the key to include in packet
+    std::shared_ptr<crypto_aead_aes256gcm_state> gcm{}; // expanded AES key (if hardware supports it)
 };
 
 struct SigMgrAEAD final : SigMgr {
+    static constexpr size_t macSize = crypto_aead_chacha20poly1305_IETF_ABYTES;
+    static constexpr size_t sigSize = nonceSize + macSize; // SignatureValue is nonce || mac
+    static constexpr size_t maxKeys = 4;    // most recent keys kept for decryption
+    static constexpr size_t keyIdOff = 9;   // offset of key id in SigInfo
+    using adSpan = std::span<const uint8_t>;
+
     unsigned char m_nonceUnique[nonceSize];
-    std::vector<keyRecord> m_keyList;
-    size_t m_decryptIndex;
+    std::vector<keyRecord> m_keyList;   // newest key first
+    std::vector<uint8_t> m_ad{};    // AES-GCM needs contiguous Associated Data (reused buffer)
 
-    SigMgrAEAD() : SigMgr(stAEAD, {0x16, 0x03, 0x1b, 0x01, stAEAD}) {
+    static bool gcmAvailable() noexcept {
+        static const bool avail = sodium_init() != -1 && crypto_aead_aes256gcm_is_available();
+        return avail;
+    }
+    // the requested type if it can be used on this machine
+    static SigType aeadType(SigType typ) {
+        if (typ == stAEADGCM && ! gcmAvailable())
+            throw std::runtime_error("SigMgrAEAD: AEADGCM needs AES-NI & PCLMUL which this cpu lacks");
+        return typ == stAEADGCM? stAEADGCM : stAEAD;
+    }
+
+    explicit SigMgrAEAD(SigType typ = stAEAD) :
+        SigMgr(aeadType(typ), {0x16, 0x0b, 0x1b, 0x01, typ == stAEADGCM? stAEADGCM : stAEAD,
+                               0x1c, 0x06, 0x1d, 0x04, 0, 0, 0, 0}) {
         if (sodium_init() == -1) exit(EXIT_FAILURE);
         randombytes_buf(m_nonceUnique, sizeof m_nonceUnique); //always done - set unique part of nonce (12 bytes)
     }
 
-    //update to signing keyList with these values (keyList keeps no more than two keys)
+    //update to signing keyList with these values (keyList keeps no more than maxKeys keys)
     virtual void addKey(const keyVal& k,  uint64_t ktm) override final {
+        if (k.size() != aeadkeySize)
+            throw std::runtime_error("SigMgrAEAD::addKey: group key must be " + std::to_string(aeadkeySize) + " bytes");
+        keyRecord kr(k, ktm);
+        if (gcmAvailable()) {
+            kr.gcm = std::make_shared<crypto_aead_aes256gcm_state>();
+            crypto_aead_aes256gcm_beforenm(kr.gcm.get(), k.data());
+        }
+        // a key with the same id replaces the old one
+        std::erase_if(m_keyList, [id=kr.id](const auto& r){ return r.id == id; });
         //add to front of key vector
-        m_keyList.insert(m_keyList.begin(), keyRecord(k, ktm));
-        if(m_keyList.size() > 2)   //keep no more than 2 keys
+        m_keyList.insert(m_keyList.begin(), std::move(kr));
+        if(m_keyList.size() > maxKeys)
             m_keyList.pop_back();
-        m_decryptIndex = (keyListSize() > 1) ? 1 : 0;
+        // packets are signed with the newest key so put its id in our SigInfo
+        for (size_t i = 0; i < 4; i++) m_sigInfo[keyIdOff + i] = m_keyList.front().id >> (i * 8);
     }
 
+    // return the key with id 'id' or nullptr if there isn't one
+    const keyRecord* findKey(uint32_t id) const noexcept {
+        for (const auto& kr : m_keyList) if (kr.id == id) return &kr;
+        return nullptr;
+    }
+
+    /*
+     * The Data is encoded once with a placeholder SignatureValue of the final
+     * size then the Content is encrypted in place in that wire buffer and the
+     * nonce & mac are written into the SignatureValue. The Associated Data is
+     * the signed portion of the wire minus the Content value so is passed as
+     * two spans over the buffer (the parts before & after the Content value).
+     * The Data's fields are then rebound to the encrypted wire by decoding it
+     * (the wire buffer becomes the Data's cached encoding, no re-encode).
+     */
     bool sign(ndn_ind::Data& data, const SigInfo&, const keyVal&) override final {
         if(!keyListSize()) return false;    //can't sign without a key
-        ///set the Signature field (empty Signature Value - TLV 0x17 and 0x00)
-        auto dataWF = setupSignature(data, m_sigInfo);
-        size_t mlen = data.getContent().size();
-        std::vector<uint8_t> msg (data.getContent()->data(), data.getContent()->data() + mlen);
-        //get the Associated Data: front bytes plus Signature Info
+        auto dataWF = setupSignature(data, m_sigInfo, sigSize);
+        // the encoding was just created for this Data so can be modified in place
+        auto sb = const_cast<uint8_t*>(dataWF.signedBuf());
+        auto mlen = data.getContent().size();
         auto adlen = dataWF.signedSize() - (mlen + m_sigInfo.size());
-        std::vector<uint8_t> ad (dataWF.signedBuf(), dataWF.signedBuf() + adlen);
-        ad.insert(ad.end(), std::begin(m_sigInfo), std::end(m_sigInfo));
+        auto cont = sb + adlen;
+        auto sigValue = const_cast<uint8_t*>(dataWF.buf()) + dataWF.size() - sigSize;
 
-        uint8_t cipherCont[mlen];       //cipher content length same as original
-        unsigned char mac[crypto_aead_chacha20poly1305_IETF_ABYTES];
-        unsigned long long maclen;      //expect crypto_aead_chacha20poly1305_IETF_ABYTES
         unsigned char* curKey = nullptr;
         unsigned char* curIV = nullptr;
         getEncryptKey(curKey, curIV);
         auto ivX = sizeof(curIV); //array of bytes so equals no. elements
         //set up nonce and place in sigValue (m_nonceUnique len >= curIV)
-        std::vector<uint8_t> sigValue;
         for(size_t i=0; i<nonceSize; ++i)
-        {
-            if(i < ivX)
-                sigValue.push_back(m_nonceUnique[i] ^ curIV[i]);
-            else
-                sigValue.push_back(m_nonceUnique[i]);
+            sigValue[i] = i < ivX ? m_nonceUnique[i] ^ curIV[i] : m_nonceUnique[i];
+        if (m_type == stAEADGCM) {
+            unsigned long long maclen;
+            auto ad = gcmAD(adSpan(sb, adlen), adSpan(cont + mlen, m_sigInfo.size()));
+            crypto_aead_aes256gcm_encrypt_detached_afternm(cont, sigValue + nonceSize, &maclen, cont, mlen,
+                                 ad, m_ad.size(), NULL, sigValue, m_keyList.front().gcm.get());
+        } else {
+            encrypt(cont, mlen, adSpan(sb, adlen), adSpan(cont + mlen, m_sigInfo.size()),
+                    sigValue, curKey, sigValue + nonceSize);
         }
-        crypto_aead_chacha20poly1305_ietf_encrypt_detached(cipherCont, mac, &maclen,
-                             msg.data(), mlen,         //to be encrypted
-                             ad.data(), ad.size(),    //the associated data
-                             NULL, sigValue.data(), curKey);
         sodium_increment(&m_nonceUnique[0], nonceSize);
-        data.setContent(cipherCont, mlen);
-
-        //set up Signature value as nonce append mac
-        sigValue.insert (sigValue.end(), mac, mac+maclen);
-        data.getSignature()->setSignature(sigValue);
-        data.wireEncode(); //Encode again including the signature
+        data.wireDecode(dataWF);
         return true;
     }
     /*
@@ -143,33 +205,94 @@ struct SigMgrAEAD final : SigMgr {
         //can't decrypt without a key
         if(!keyListSize()) return false;
 
-        auto mlen = data.getContent().size();
-        std::vector<uint8_t> msg (data.getContent()->data(), data.getContent()->data() + mlen);
         //sigValue holds nonce append mac
-        auto sigValue = data.getSignature()->getSignature();
-        if(sigValue.size() != nonceSize + crypto_aead_chacha20poly1305_IETF_ABYTES) return false;
+        const auto& sigValue = data.getSignature()->getSignature();
+        if(sigValue.size() != sigSize) return false;
 
-        //get the Associated Data: front bytes plus Signature Info
+        //get the Associated Data (as spans over the wire): front bytes plus Signature Info
         auto dataWF = data.wireEncode();
+        const auto& cont = data.getContent();
+        auto mlen = cont.size();
         auto adlen = dataWF.signedSize() - (mlen + m_sigInfo.size());
-        std::vector<uint8_t> ad (dataWF.signedBuf(), dataWF.signedBuf() + adlen);
-        ad.insert(ad.end(), dataWF.signedBuf()+adlen+mlen, dataWF.signedBuf()+dataWF.signedSize());
-
-        unsigned char decrypted[mlen];
-        auto i = m_decryptIndex;    //start with last successful key
-        do {
-            unsigned char* curKey = m_keyList[i].key.data();
-            if(crypto_aead_chacha20poly1305_ietf_decrypt_detached(decrypted,
-                             NULL, msg.data(), mlen, sigValue.buf()+nonceSize,
-                             ad.data(), ad.size(), sigValue.buf(), curKey) == 0)
-            {
-                m_decryptIndex = i; //successful key index
-                data.setContent(decrypted, mlen);
-                return true;
-             }
-             i = (i + 1) % keyListSize();
-        } while (i != m_decryptIndex);
-        return false;
+        adSpan ad1(dataWF.signedBuf(), adlen);
+        adSpan ad2(dataWF.signedBuf() + adlen + mlen, dataWF.signedSize() - adlen - mlen);
+        // ad2 is the packet's SignatureInfo which holds its signature type and key id
+        if (ad2.size() != m_sigInfo.size() ||
+            ! std::equal(ad2.begin(), ad2.begin() + 4, m_sigInfo.begin()) ||
+            ! std::equal(ad2.begin() + 5, ad2.begin() + keyIdOff, m_sigInfo.begin() + 5)) return false;
+        auto ptype = ad2[4];
+        if (ptype != stAEAD && (ptype != stAEADGCM || !gcmAvailable())) return false;
+        uint32_t id = 0;
+        for (size_t i = 0; i < 4; i++) id |= uint32_t(ad2[keyIdOff + i]) << (i * 8);
+        const auto kr = findKey(id);
+        if (kr == nullptr) return false;
+
+        // decrypt directly into the buffer that becomes the new Content
+        auto decrypted = std::make_shared<std::vector<uint8_t>>(mlen);
+        bool ok;
+        if (ptype == stAEADGCM) {
+            auto ad = gcmAD(ad1, ad2);
+            ok = crypto_aead_aes256gcm_decrypt_detached_afternm(decrypted->data(), NULL, cont.buf(), mlen,
+                                 sigValue.buf() + nonceSize, ad, m_ad.size(), sigValue.buf(), kr->gcm.get()) == 0;
+        } else {
+            ok = decrypt(decrypted->data(), cont.buf(), mlen, ad1, ad2, sigValue.buf(),
+                         kr->key.data(), sigValue.buf() + nonceSize);
+        }
+        if (! ok) return false;
+        data.setContent(ndn_ind::Blob(decrypted, false));
+        return true;
+    }
+
+    /*
+     * ChaCha20-Poly1305 (RFC 8439) with the Associated Data supplied in two pieces.
+     * libsodium's crypto_aead_chacha20poly1305_ietf_*_detached need contiguous AD so
+     * the construction is done here from the same primitives. The results are
+     * byte-for-byte identical to those routines. Encryption is done in place.
+     */
+    static void computeMac(uint8_t* mac, adSpan ad1, adSpan ad2, const uint8_t* c, size_t clen,
+                           const uint8_t* nonce, const uint8_t* key) {
+        static constexpr uint8_t pad0[16]{};
+        uint8_t block0[64];
+        crypto_stream_chacha20_ietf(block0, sizeof(block0), nonce, key);
+        crypto_onetimeauth_poly1305_state st;
+        crypto_onetimeauth_poly1305_init(&st, block0);
+        sodium_memzero(block0, sizeof(block0));
+
+        uint64_t adlen = ad1.size() + ad2.size();
+        crypto_onetimeauth_poly1305_update(&st, ad1.data(), ad1.size());
+        crypto_onetimeauth_poly1305_update(&st, ad2.data(), ad2.size());
+        crypto_onetimeauth_poly1305_update(&st, pad0, (0x10 - adlen) & 0xf);
+        crypto_onetimeauth_poly1305_update(&st, c, clen);
+        crypto_onetimeauth_poly1305_update(&st, pad0, (0x10 - clen) & 0xf);
+        uint8_t lens[16];
+        for (int i = 0; i < 8; i++) {
+            lens[i] = adlen >> (i * 8);
+            lens[i + 8] = uint64_t(clen) >> (i * 8);
+        }
+        crypto_onetimeauth_poly1305_update(&st, lens, sizeof(lens));
+        crypto_onetimeauth_poly1305_final(&st, mac);
+    }
+
+    // assemble the two pieces of Associated Data in m_ad for the AES-GCM routines
+    const uint8_t* gcmAD(adSpan ad1, adSpan ad2) {
+        m_ad.assign(ad1.begin(), ad1.end());
+        m_ad.insert(m_ad.end(), ad2.begin(), ad2.end());
+        return m_ad.data();
+    }
+
+    static void encrypt(uint8_t* c, size_t mlen, adSpan ad1, adSpan ad2, const uint8_t* nonce,
+                        const uint8_t* key, uint8_t* mac) {
+        crypto_stream_chacha20_ietf_xor_ic(c, c, mlen, nonce, 1U, key);
+        computeMac(mac, ad1, ad2, c, mlen, nonce, key);
+    }
+
+    static bool decrypt(uint8_t* m, const uint8_t* c, size_t clen, adSpan ad1, adSpan ad2,
+                        const uint8_t* nonce, const uint8_t* key, const uint8_t* mac) {
+        uint8_t computed[macSize];
+        computeMac(computed, ad1, ad2, c, clen, nonce, key);
+        if (crypto_verify_16(computed, mac) != 0) return false;
+        crypto_stream_chacha20_ietf_xor_ic(m, c, clen, nonce, 1U, key);
+        return true;
     }
 
     inline size_t keyListSize() const { return m_keyList.size(); }
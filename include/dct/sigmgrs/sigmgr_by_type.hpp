@@ -36,6 +36,9 @@
  *  0x08 EdDSA
  *  0x09 RFC7693
  *  0x0a NULL
+ *  0x0b AEADGCM (handled by SigMgrAEAD)
+ *  0x0c MAC
+ *  0x0d EdDSAMerkle (batch signatures handled by SigMgrEdDSA)
  */
 #include <string>
 #include <string_view>
@@ -44,6 +47,7 @@
 #include "../format.hpp"
 #include "sigmgr_aead.hpp"
 #include "sigmgr_eddsa.hpp"
+#include "sigmgr_mac.hpp"
 #include "sigmgr_rfc7693.hpp"
 #include "sigmgr_sha256.hpp"
 #include "sigmgr_null.hpp"
@@ -53,37 +57,90 @@ using namespace std::string_literals;
 template<class... Ts> struct overload : Ts... { using Ts::operator()...; };
 template<class... Ts> overload(Ts...) -> overload<Ts...>;
 
-using Variants = std::variant<SigMgrSHA256,SigMgrAEAD,SigMgrRFC7693,SigMgrNULL,SigMgrEdDSA>;
+using Variants = std::variant<SigMgrSHA256,SigMgrAEAD,SigMgrRFC7693,SigMgrNULL,SigMgrEdDSA,SigMgrMAC>;
 
 struct SigMgrAny : Variants {
     using Variants::Variants;
 
     // return a reference to whichever sigmgr is in the variant
-    SigMgr& ref() const noexcept { return (SigMgr&)*this; }
+    SigMgr& ref() noexcept { return std::visit([](auto& sm) -> SigMgr& { return sm; }, (Variants&)*this); }
+    const SigMgr& ref() const noexcept {
+        return std::visit([](const auto& sm) -> const SigMgr& { return sm; }, (const Variants&)*this);
+    }
 
-    // validate 'd' using whichever sigmgr is set in the variant
-    bool validate(const ndn_ind::Data& d) { return ref().validate(d); }
-    bool validateDecrypt(ndn_ind::Data& d) { return ref().validateDecrypt(d); }
-    bool validate(const ndn_ind::Data& d, const dct_Cert& c) { return ref().validate(d, c); };
+    // sign/validate 'd' using whichever sigmgr is set in the variant. The
+    // visitor is instantiated for each (final) sigmgr type so the calls are
+    // bound at compile time rather than going through SigMgr's vtable.
+    bool sign(ndn_ind::Data& d) {
+        return std::visit([&d](auto& sm) { return sigmgrPolicy<std::decay_t<decltype(sm)>>::sign(sm, d); },
+                          (Variants&)*this);
+    }
+    bool signBatch(std::span<ndn_ind::Data> b) {
+        return std::visit([b](auto& sm) { return sigmgrPolicy<std::decay_t<decltype(sm)>>::signBatch(sm, b); },
+                          (Variants&)*this);
+    }
+    bool validate(const ndn_ind::Data& d) {
+        return std::visit([&d](auto& sm) { return sigmgrPolicy<std::decay_t<decltype(sm)>>::validate(sm, d); },
+                          (Variants&)*this);
+    }
+    bool validateDecrypt(ndn_ind::Data& d) {
+        return std::visit([&d](auto& sm) { return sigmgrPolicy<std::decay_t<decltype(sm)>>::validateDecrypt(sm, d); },
+                          (Variants&)*this);
+    }
+    bool validate(const ndn_ind::Data& d, const dct_Cert& c) {
+        return std::visit([&d,&c](auto& sm) { return sigmgrPolicy<std::decay_t<decltype(sm)>>::validate(sm, d, c); },
+                          (Variants&)*this);
+    }
 
     bool needsKey() const noexcept { return ref().needsKey(); };
 };
 
+// SigMgrAny as a sigmgr policy: dispatch is by variant index instead of vtable
+template<>
+struct sigmgrPolicy<SigMgrAny> {
+    static SigMgr& ref(SigMgrAny& sm) noexcept { return sm.ref(); }
+
+    static bool sign(SigMgrAny& sm, ndn_ind::Data& d) { return sm.sign(d); }
+    static bool signBatch(SigMgrAny& sm, std::span<ndn_ind::Data> b) { return sm.signBatch(b); }
+    static bool validate(SigMgrAny& sm, const ndn_ind::Data& d) { return sm.validate(d); }
+    static bool validate(SigMgrAny& sm, const ndn_ind::Data& d, const dct_Cert& c) { return sm.validate(d, c); }
+    static bool validateDecrypt(SigMgrAny& sm, ndn_ind::Data& d) { return sm.validateDecrypt(d); }
+};
+
+// Convert the SigMgrAny returned by sigMgrByType() to the sigmgr type 'SM'
+// some templated user was instantiated with. Throws if the variant doesn't
+// hold an 'SM' (i.e., the schema's signer type isn't the compiled-in one).
+template<typename SM>
+static inline SM sigMgrAs(SigMgrAny&& sm) {
+    if constexpr (std::is_same_v<SM, SigMgrAny>) {
+        return std::move(sm);
+    } else {
+        if (! std::holds_alternative<SM>(sm))
+            throw std::runtime_error(format("sigMgrAs: schema signer type {} doesn't match compiled type",
+                                            sm.ref().type()));
+        return std::get<SM>(std::move(sm));
+    }
+}
+
 static inline const std::unordered_map<std::string,uint8_t> sigmgr_name_to_type {
     {"SHA256"s,  SigMgr::stSHA256},
     {"AEAD",     SigMgr::stAEAD},
+    {"AEADGCM"s, SigMgr::stAEADGCM},
     {"EdDSA"s,   SigMgr::stEdDSA},
     {"RFC7693"s, SigMgr::stRFC7693},
-    {"NULL"s,    SigMgr::stNULL}
+    {"NULL"s,    SigMgr::stNULL},
+    {"MAC"s,     SigMgr::stMAC}
 };
 
 static inline SigMgrAny sigMgrByType(uint8_t type) {
     switch (type) {
         case SigMgr::stSHA256:  return SigMgrSHA256();
         case SigMgr::stAEAD:    return SigMgrAEAD();
+        case SigMgr::stAEADGCM: return SigMgrAEAD(SigMgr::stAEADGCM);
         case SigMgr::stEdDSA:   return SigMgrEdDSA();
         case SigMgr::stRFC7693: return SigMgrRFC7693();
         case SigMgr::stNULL:    return SigMgrNULL();
+        case SigMgr::stMAC:     return SigMgrMAC();
     }
     throw std::runtime_error(format("sigMgrByType: unknown signer type {}", type));
 }
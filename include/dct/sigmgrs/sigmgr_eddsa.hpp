@@ -65,8 +65,29 @@
  *      fields that are computed for each Data
  */
 
+/*
+ * Merkle batch signatures (signature type 0x0d, EdDSAMerkle)
+ *
+ * signBatch() covers a batch of locally produced pubs (e.g., the segments
+ * of a multi-segment message) with a single EdDSA signature. Each pub's
+ * SigInfo is the normal one with the type changed to 0x0d. The leaves of
+ * a binary Merkle tree are the BLAKE2b hash of 0x00 followed by each pub's
+ * signed portion and interior nodes are the BLAKE2b hash of 0x01 followed
+ * by the left & right child (an odd node at the end of a level moves up
+ * unchanged). The 'rootCtx' string followed by the tree root is signed.
+ * Each pub's SignatureValue is:
+ *   <64 byte EdDSA signature of root> <leaf index (2 bytes LE)>
+ *   <batch size (2 bytes LE)> <sibling hashes from leaf to root (32 bytes each)>
+ * so any pub can be validated by itself. Validators cache verified roots
+ * so the EdDSA check is done once per batch, not once per pub.
+ */
+
 #include <array>
+#include <span>
+#include <string_view>
+#include <vector>
 #include "sigmgr.hpp"
+#include "sig_cache.hpp"
 #include "dct/schema/dct_cert.hpp"
 
 /*
@@ -88,6 +109,10 @@
  */
 
 struct SigMgrEdDSA final : SigMgr {    
+    // Successful verifications are remembered so duplicate arrivals of a
+    // pub or cert skip the crypto. Since SigMgrSchema does its crypto check
+    // via its pub sigmgr, this cache also covers pubs validated through it.
+    sigCache m_cache{};
 
     SigMgrEdDSA() :
         SigMgr(stEdDSA,
@@ -116,6 +141,116 @@ struct SigMgrEdDSA final : SigMgr {
     /* private signing key */
     void addKey(const keyVal& sk, uint64_t = 0) override final { m_signingKey.assign(sk.begin(), sk.end()); }
 
+    // Merkle batch signing (see the description at the top of this file)
+    using mHash = std::array<uint8_t,crypto_generichash_BYTES>;
+    static constexpr std::string_view rootCtx{"DCT EdDSA Merkle root"};
+    static constexpr size_t batchHdrSz = crypto_sign_BYTES + 4;
+    static constexpr size_t maxBatch = 65535;
+
+    static mHash leafHash(const uint8_t* sp, size_t sz) {
+        static constexpr uint8_t pre = 0;
+        mHash h;
+        crypto_generichash_state st;
+        crypto_generichash_init(&st, nullptr, 0, h.size());
+        crypto_generichash_update(&st, &pre, 1);
+        crypto_generichash_update(&st, sp, sz);
+        crypto_generichash_final(&st, h.data(), h.size());
+        return h;
+    }
+    static mHash nodeHash(const uint8_t* l, const uint8_t* r) {
+        static constexpr uint8_t pre = 1;
+        mHash h;
+        crypto_generichash_state st;
+        crypto_generichash_init(&st, nullptr, 0, h.size());
+        crypto_generichash_update(&st, &pre, 1);
+        crypto_generichash_update(&st, l, h.size());
+        crypto_generichash_update(&st, r, h.size());
+        crypto_generichash_final(&st, h.data(), h.size());
+        return h;
+    }
+    static auto rootMsg(const mHash& root) {
+        std::array<uint8_t, rootCtx.size() + sizeof(mHash)> m;
+        std::copy(rootCtx.begin(), rootCtx.end(), m.begin());
+        std::copy(root.begin(), root.end(), m.begin() + rootCtx.size());
+        return m;
+    }
+
+    bool batchSigning() const noexcept override final { return true; }
+
+    bool signBatch(std::span<ndn_ind::Data> batch) override final {
+        if (batch.size() < 2 || batch.size() > maxBatch) return SigMgr::signBatch(batch);
+        if (m_signingKey.empty()) throw std::runtime_error("SigMgrEdDSA: can't sign without a key");
+
+        auto si = m_sigInfo;
+        si[4] = stEdDSAMerkle;
+        // tree levels from the leaves up to the root
+        std::vector<std::vector<mHash>> lev(1);
+        lev[0].reserve(batch.size());
+        for (auto& d : batch) {
+            auto wf = setupSignature(d, si);
+            lev[0].emplace_back(leafHash(wf.signedBuf(), wf.signedSize()));
+        }
+        while (lev.back().size() > 1) {
+            const auto& l = lev.back();
+            std::vector<mHash> nl{};
+            nl.reserve((l.size() + 1) / 2);
+            for (size_t i = 0; i + 1 < l.size(); i += 2) nl.emplace_back(nodeHash(l[i].data(), l[i+1].data()));
+            if (l.size() & 1) nl.emplace_back(l.back());
+            lev.emplace_back(std::move(nl));
+        }
+        std::vector<uint8_t> sv(batchHdrSz);
+        auto rm = rootMsg(lev.back()[0]);
+        crypto_sign_detached(sv.data(), nullptr, rm.data(), rm.size(), m_signingKey.data());
+        const uint16_t n = batch.size();
+        sv[crypto_sign_BYTES + 2] = n;
+        sv[crypto_sign_BYTES + 3] = n >> 8;
+
+        for (uint16_t i = 0; i < n; ++i) {
+            sv.resize(batchHdrSz);
+            sv[crypto_sign_BYTES] = i;
+            sv[crypto_sign_BYTES + 1] = i >> 8;
+            size_t p = i;
+            for (size_t l = 0; l + 1 < lev.size(); ++l, p >>= 1) {
+                if ((p ^ 1) < lev[l].size()) sv.insert(sv.end(), lev[l][p ^ 1].begin(), lev[l][p ^ 1].end());
+            }
+            batch[i].getSignature()->setSignature(sv);
+            batch[i].wireEncode();
+        }
+        return true;
+    }
+
+    // check a batch signature 'sig' of 'data' whose wire format is 'wf'
+    bool validateBatch(const ndn_ind::Data& data, const ndn_ind::SignedBlob& wf,
+                       const ndn_ind::Blob& sig, const keyVal& pk) {
+        try {
+            if (dctCert::getSigType(data) != stEdDSAMerkle) return false;
+        } catch (const std::exception&) { return false; }
+        if (sig.size() < batchHdrSz || (sig.size() - batchHdrSz) % sizeof(mHash)) return false;
+        const auto* sb = sig.buf();
+        size_t p = sb[crypto_sign_BYTES] | sb[crypto_sign_BYTES + 1] << 8;
+        size_t n = sb[crypto_sign_BYTES + 2] | sb[crypto_sign_BYTES + 3] << 8;
+        if (p >= n) return false;
+
+        // walk up the tree to the root
+        auto h = leafHash(wf.signedBuf(), wf.signedSize());
+        const auto* path = sb + batchHdrSz;
+        const auto* pathEnd = sb + sig.size();
+        for (; n > 1; p >>= 1, n = (n + 1) / 2) {
+            if ((p ^ 1) >= n) continue; // odd node moved up
+            if (path == pathEnd) return false;
+            h = (p & 1)? nodeHash(path, h.data()) : nodeHash(h.data(), path);
+            path += sizeof(mHash);
+        }
+        if (path != pathEnd) return false;
+
+        auto rm = rootMsg(h);
+        auto rd = sigCache::hash(rm, pk);
+        if (m_cache.contains(rd)) return true;
+        if (crypto_sign_verify_detached(sb, rm.data(), rm.size(), pk.data()) != 0) return false;
+        m_cache.insert(rd);
+        return true;
+    }
+
     /*
      * This method is added for use by Certificates
      * (or anything that needs additions to sigInfo)
@@ -137,11 +272,18 @@ struct SigMgrEdDSA final : SigMgr {
     }
 
     // common validate logic for both API calls
-    bool validate(const ndn_ind::Data& data, const keyVal& pk) const {
-        auto sig = data.getSignature()->getSignature();
-        if((sig.size()) != crypto_sign_BYTES) return false;
+    bool validate(const ndn_ind::Data& data, const keyVal& pk) {
+        const auto& sig = data.getSignature()->getSignature();
+        if (sig.size() < crypto_sign_BYTES) return false;
         const auto& wf = data.wireEncode();
-        if (crypto_sign_verify_detached(sig.buf(), wf.signedBuf(), wf.signedSize(), pk.data()) != 0) return false;
+        auto d = sigCache::hash({wf.buf(), wf.size()}, pk);
+        if (m_cache.contains(d)) return true;
+        if (sig.size() != crypto_sign_BYTES) {
+            if (! validateBatch(data, wf, sig, pk)) return false;
+        } else if (crypto_sign_verify_detached(sig.buf(), wf.signedBuf(), wf.signedSize(), pk.data()) != 0) {
+            return false;
+        }
+        m_cache.insert(d);
         return true;
     }
     bool validate(const ndn_ind::Data& data, const dct_Cert& scert) override final {
@@ -0,0 +1,111 @@
+#ifndef SIGMGRMAC_HPP
+#define SIGMGRMAC_HPP
+/*
+ * Keyed-MAC (group authentication) Signature Manager
+ *
+ * Copyright (C) 2020 Pollere, Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, see <https://www.gnu.org/licenses/>.
+ *  You may contact Pollere, Inc at info@pollere.net.
+ *
+ *  The DCT proof-of-concept is not intended as production code.
+ *  More information on DCT is available from info@pollere.net
+ */
+
+/*
+ * SigMgr MAC provides group authenticity (but not confidentiality) for
+ * wire packets at the cost of a hash. The SignatureValue is the keyed BLAKE2b
+ * (RFC7693, libsodium's crypto_generichash with a key) of the packet's signed
+ * portion using the symmetric group key distributed by DistGKey (the same
+ * key distribution used by SigMgrAEAD). Anyone holding the group key can
+ * sign so, unlike EdDSA, it doesn't identify the individual signer.
+ *
+ * validate() finds the group key named by the packet's key id, recomputes
+ * the MAC and does a constant time compare with the SignatureValue.
+ */
+
+/*
+ * The SignatureInfo content is fixed 13 bytes for this signing method:
+ *  0x16 (SigInfo) <number of bytes to follow in SigInfo>
+ *  0x1b (SignatureType) <number of bytes to follow that give signatureType>
+ *  0x0c (this SIGNER Type)
+ *  0x1c (KeyLocator) 0x06 0x1d (KeyDigest) 0x04 followed by
+ *   <4 byte key id: low order 4 bytes (little-endian) of the group key's creation time>
+ *  Followed by:
+ *  0x17 (SignatureValueType) <number of bytes in signature> <signature bytes>
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "sigmgr.hpp"
+
+struct SigMgrMAC final : SigMgr {
+    static constexpr size_t macSize = crypto_generichash_BYTES;
+    static constexpr size_t maxKeys = 4;    // most recent keys kept for validation
+    static constexpr size_t keyIdOff = 9;   // offset of key id in SigInfo
+    static_assert(crypto_generichash_KEYBYTES == crypto_aead_chacha20poly1305_IETF_KEYBYTES,
+                  "MAC keys come from the AEAD group key distributor");
+
+    std::vector<std::pair<uint32_t,keyVal>> m_keyList{}; // (key id, key), newest key first
+
+    SigMgrMAC() : SigMgr(stMAC, {0x16, 0x0b, 0x1b, 0x01, stMAC, 0x1c, 0x06, 0x1d, 0x04, 0, 0, 0, 0}) {
+        if (sodium_init() == -1) exit(EXIT_FAILURE);
+    }
+
+    // new group key 'k' created at time 'ktm' (keyList keeps no more than maxKeys keys)
+    void addKey(const keyVal& k, uint64_t ktm) override final {
+        if (k.size() != crypto_generichash_KEYBYTES) return;
+        auto id = uint32_t(ktm);
+        std::erase_if(m_keyList, [id](const auto& r){ return r.first == id; });
+        m_keyList.emplace(m_keyList.begin(), id, k);
+        if (m_keyList.size() > maxKeys) m_keyList.pop_back();
+        // packets are signed with the newest key so put its id in our SigInfo
+        for (size_t i = 0; i < 4; i++) m_sigInfo[keyIdOff + i] = id >> (i * 8);
+    }
+
+    bool sign(ndn_ind::Data& data, const SigInfo&, const keyVal&) override final {
+        if (m_keyList.empty()) return false;    //can't sign without a key
+        auto dataWF = setupSignature(data, m_sigInfo);
+        std::vector<uint8_t> sigValue(macSize);
+        const auto& key = m_keyList.front().second;
+        crypto_generichash(sigValue.data(), sigValue.size(), dataWF.signedBuf(), dataWF.signedSize(),
+                           key.data(), key.size());
+        data.getSignature()->setSignature(sigValue);
+        // Encode again to include the signature.
+        dataWF = data.wireEncode();
+        return true;
+    }
+
+    bool validate(const ndn_ind::Data& data) override final {
+        const auto& sig = data.getSignature()->getSignature();
+        if (sig.size() != macSize) return false;
+        const auto& dataWF = data.wireEncode();
+        // SigInfo is the last thing in the signed portion
+        if (dataWF.signedSize() < m_sigInfo.size()) return false;
+        auto si = dataWF.signedBuf() + dataWF.signedSize() - m_sigInfo.size();
+        if (! std::equal(m_sigInfo.begin(), m_sigInfo.begin() + keyIdOff, si)) return false;
+        uint32_t id = 0;
+        for (size_t i = 0; i < 4; i++) id |= uint32_t(si[keyIdOff + i]) << (i * 8);
+        auto kr = std::find_if(m_keyList.begin(), m_keyList.end(), [id](const auto& r){ return r.first == id; });
+        if (kr == m_keyList.end()) return false;
+
+        uint8_t mac[macSize];
+        crypto_generichash(mac, macSize, dataWF.signedBuf(), dataWF.signedSize(), kr->second.data(), kr->second.size());
+        return crypto_verify_32(mac, sig.buf()) == 0;
+    }
+    bool validate(const ndn_ind::Data& data, const dct_Cert&) override final { return validate(data); }
+};
+
+#endif // SIGMGRMAC_HPP
@@ -53,6 +53,7 @@
 #ifndef SYNCPS_IBLT_HPP
 #define SYNCPS_IBLT_HPP
 
+#include <array>
 #include <cmath>
 #include <inttypes.h>
 #include <iomanip>
@@ -60,7 +61,7 @@
 #include <set>
 #include <sstream>
 #include <string>
-#include <vector>
+#include <type_traits>
 
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/device/array.hpp>
@@ -82,17 +83,46 @@ namespace bio = boost::iostreams;
 static constexpr size_t N_HASH{3};
 static constexpr size_t N_HASHCHECK{11};
 
+/*
+ * Number of cells needed for an IBLT that should decode 'expectedNumEntries'
+ * differences. 1.5x expectedNumEntries gives very low probability of decoding
+ * failure and the result is rounded up to be exactly divisible by N_HASH.
+ */
+static constexpr size_t ibltCells(size_t expectedNumEntries) noexcept
+{
+    size_t nEntries = expectedNumEntries + expectedNumEntries / 2;
+    return nEntries + (N_HASH - nEntries % N_HASH) % N_HASH;
+}
+
+/*
+ * murmurHash3 of a key. 32 bit keys use the ndn-ind integer version (so
+ * their hashes are unchanged from the original PSync iblt) while wider
+ * keys are hashed as their (little-endian) bytes.
+ */
+template<typename HashVal>
+static inline uint32_t ibltHash(uint32_t seed, HashVal key) noexcept
+{
+    if constexpr (sizeof(HashVal) == sizeof(uint32_t)) {
+        return ndn_ind::CryptoLite::murmurHash3(seed, uint32_t(key));
+    } else {
+        uint8_t b[sizeof(HashVal)];
+        for (size_t i = 0; i < sizeof(HashVal); i++) b[i] = key >> (i * 8);
+        return ndn_ind::CryptoLite::murmurHash3(seed, b, sizeof(b));
+    }
+}
+
+template<typename HashVal>
 class HashTableEntry
 {
    public:
     int32_t count;
-    uint32_t keySum;
+    HashVal keySum;
     uint32_t keyCheck;
 
     bool isPure() const
     {
         if (count == 1 || count == -1) {
-            uint32_t check = ndn_ind::CryptoLite::murmurHash3(N_HASHCHECK, keySum);
+            uint32_t check = ibltHash(N_HASHCHECK, keySum);
             return keyCheck == check;
         }
         return false;
@@ -101,51 +131,75 @@ class HashTableEntry
     {
         return count == 0 && keySum == 0 && keyCheck == 0;
     }
+    bool operator==(const HashTableEntry&) const = default;
 };
 
-class IBLT;
-static inline std::ostream& operator<<(std::ostream& out, const IBLT& iblt);
-static inline std::ostream& operator<<(std::ostream& out, const HashTableEntry& hte);
+template<size_t N, typename HashVal> class IBLT;
+template<size_t N, typename HashVal>
+static inline std::ostream& operator<<(std::ostream& out, const IBLT<N, HashVal>& iblt);
+template<typename HashVal>
+static inline std::ostream& operator<<(std::ostream& out, const HashTableEntry<HashVal>& hte);
 
 /**
  * @brief Invertible Bloom Lookup Table (Invertible Bloom Filter)
  *
  * Used by Partial Sync (PartialProducer) and Full Sync (Full Producer)
+ *
+ * The table has a compile-time size of N cells (which must be a multiple
+ * of N_HASH, see ibltCells()) and holds keys of type HashVal (an unsigned
+ * integer). Wider keys make hash collisions between distinct items, which
+ * cause silent non-delivery, much less likely at high item rates.
  */
+template<size_t N, typename HashVal = uint32_t>
 class IBLT
 {
+    static_assert(N > 0 && N % N_HASH == 0, "IBLT size must be a non-zero multiple of N_HASH");
+    static_assert(std::is_unsigned_v<HashVal>, "IBLT keys must be unsigned integers");
+
   private:
     static constexpr int INSERT = 1;
     static constexpr int ERASE = -1;
 
+    // each of the N_HASH sub-tables has 'stsize' cells
+    static constexpr size_t stsize = N / N_HASH;
+
   public:
+    using Key = HashVal;
+    using Entry = HashTableEntry<HashVal>;
+    using HashTable = std::array<Entry, N>;
+
+    // bytes in the wire encoding of a cell: count, keySum, keyCheck
+    static constexpr size_t unitSize = sizeof(int32_t) + sizeof(HashVal) + sizeof(uint32_t);
+
     class Error : public std::runtime_error
     {
        public:
         using std::runtime_error::runtime_error;
     };
 
-    /**
-     * @brief constructor
-     *
-     * @param expectedNumEntries the expected number of entries in the IBLT
+    /*
+     * A key with its cell index in each sub-table and its check hash.
+     * Callers that insert a key then later erase it (possibly in several
+     * IBLTs of this type) can compute this once with makeKey() and
+     * avoid rehashing the key on every operation.
      */
-    explicit IBLT(size_t expectedNumEntries)
+    struct IBLTKey
     {
-        // 1.5x expectedNumEntries gives very low probability of decoding failure
-        size_t nEntries = expectedNumEntries + expectedNumEntries / 2;
-        // make nEntries exactly divisible by N_HASH
-        size_t remainder = nEntries % N_HASH;
-        if (remainder != 0) {
-            nEntries += (N_HASH - remainder);
-        }
-        m_hashTable.resize(nEntries);
-    }
+        HashVal key;
+        uint32_t hash0;
+        uint32_t hash1;
+        uint32_t hash2;
+        uint32_t check;
+    };
+
+    IBLT() = default;
+
+    IBLT(const HashTable& hashTable) : m_hashTable(hashTable) {}
 
-    IBLT(const std::vector<HashTableEntry>& hashTable) : m_hashTable(hashTable) {}
+    static constexpr size_t size() noexcept { return N; }
 
     /**
-     * @brief Populate the hash table using the vector representation of IBLT
+     * @brief Populate the hash table from its wire representation
      *
      * @param ibltName the Component representation of IBLT
      * @throws Error if size of values is not compatible with this IBF
@@ -154,16 +208,15 @@ class IBLT
     {
         const auto& values = extractValueFromName(ibltName);
 
-        if (3 * m_hashTable.size() != values.size()) {
+        if (values.size() != N * unitSize) {
             BOOST_THROW_EXCEPTION(Error("Received IBF cannot be decoded!"));
         }
-        for (size_t i = 0; i < m_hashTable.size(); i++) {
-            HashTableEntry& entry = m_hashTable.at(i);
-            if (values[i * 3] != 0) {
-                entry.count = values[i * 3];
-                entry.keySum = values[(i * 3) + 1];
-                entry.keyCheck = values[(i * 3) + 2];
-            }
+        auto v = (const uint8_t*)values.data();
+        for (auto& entry : m_hashTable) {
+            entry.count = getLE<int32_t>(v);
+            entry.keySum = getLE<HashVal>(v + sizeof(int32_t));
+            entry.keyCheck = getLE<uint32_t>(v + sizeof(int32_t) + sizeof(HashVal));
+            v += unitSize;
         }
     }
 
@@ -172,20 +225,14 @@ class IBLT
      * equal-sized sub-tables with a different hash function for each.
      * Each entry is added/deleted from all subtables.
      */
-    auto hash0(size_t key) const noexcept
-    {
-        auto stsize = m_hashTable.size() / N_HASH;
-        return ndn_ind::CryptoLite::murmurHash3(0, key) % stsize;
-    }
-    auto hash1(size_t key) const noexcept
-    {
-        auto stsize = m_hashTable.size() / N_HASH;
-        return ndn_ind::CryptoLite::murmurHash3(1, key) % stsize + stsize;
-    }
-    auto hash2(size_t key) const noexcept
+    static size_t hash0(HashVal key) noexcept { return ibltHash(0, key) % stsize; }
+    static size_t hash1(HashVal key) noexcept { return ibltHash(1, key) % stsize + stsize; }
+    static size_t hash2(HashVal key) noexcept { return ibltHash(2, key) % stsize + stsize * 2; }
+
+    static IBLTKey makeKey(HashVal key) noexcept
     {
-        auto stsize = m_hashTable.size() / N_HASH;
-        return ndn_ind::CryptoLite::murmurHash3(2, key) % stsize + stsize * 2;
+        return {key, uint32_t(hash0(key)), uint32_t(hash1(key)), uint32_t(hash2(key)),
+                ibltHash(N_HASHCHECK, key)};
     }
 
     /** validity checking for 'key' on peel or delete
@@ -197,29 +244,31 @@ class IBLT
      *  - one or more of the key's 3 hash entries is 'pure' but doesn't
      *    contain 'key'
      */
-    bool chkPeer(size_t key, size_t idx) const noexcept
+    bool chkPeer(HashVal key, size_t idx) const noexcept
     {
-        auto hte = getHashTable().at(idx);
-        return hte.isEmpty() || (hte.isPure() && hte.keySum != key);
+        const auto& hte = m_hashTable[idx];
+        return hte.isEmpty() || (hte.keySum != key && hte.isPure());
     }
 
-    bool badPeers(size_t key) const noexcept
+    bool badPeers(const IBLTKey& k) const noexcept
     {
-        return chkPeer(key, hash0(key)) || chkPeer(key, hash1(key)) ||
-               chkPeer(key, hash2(key));
+        return chkPeer(k.key, k.hash0) || chkPeer(k.key, k.hash1) || chkPeer(k.key, k.hash2);
     }
+    bool badPeers(HashVal key) const noexcept { return badPeers(makeKey(key)); }
 
-    void insert(uint32_t key) { update(INSERT, key); }
+    void insert(const IBLTKey& k) { update(INSERT, k); }
+    void insert(HashVal key) { insert(makeKey(key)); }
 
-    void erase(uint32_t key)
+    void erase(const IBLTKey& k)
     {
-        if (badPeers(key)) {
+        if (badPeers(k)) {
             std::cerr << "error - invalid iblt erase: badPeers for key "
-                      << std::hex << key << "\n";
+                      << std::hex << k.key << "\n";
             return;
         }
-        update(ERASE, key);
+        update(ERASE, k);
     }
+    void erase(HashVal key) { erase(makeKey(key)); }
 
     /**
      * @brief List all the entries in the IBLT
@@ -232,8 +281,8 @@ class IBLT
      * @param negative
      * @return true if decoding is complete successfully
      */
-    bool listEntries(std::set<uint32_t>& positive,
-                     std::set<uint32_t>& negative) const
+    bool listEntries(std::set<HashVal>& positive,
+                     std::set<HashVal>& negative) const
     {
         IBLT peeled = *this;
 
@@ -242,7 +291,8 @@ class IBLT
             peeledSomething = false;
             for (const auto& entry : peeled.m_hashTable) {
                 if (entry.isPure()) {
-                    if (peeled.badPeers(entry.keySum)) {
+                    const auto k = makeKey(entry.keySum);
+                    if (peeled.badPeers(k)) {
                         std::cerr << "error - invalid iblt: badPeers for entry:"
                             << entry << "\n";
                         return false;
@@ -252,7 +302,7 @@ class IBLT
                     } else {
                         negative.insert(entry.keySum);
                     }
-                    peeled.update(-entry.count, entry.keySum);
+                    peeled.update(-entry.count, k);
                     peeledSomething = true;
                 }
             }
@@ -263,12 +313,10 @@ class IBLT
 
     IBLT operator-(const IBLT& other) const
     {
-        BOOST_ASSERT(m_hashTable.size() == other.m_hashTable.size());
-
         IBLT result(*this);
-        for (size_t i = 0; i < m_hashTable.size(); i++) {
-            HashTableEntry& e1 = result.m_hashTable.at(i);
-            const HashTableEntry& e2 = other.m_hashTable.at(i);
+        for (size_t i = 0; i < N; i++) {
+            Entry& e1 = result.m_hashTable[i];
+            const Entry& e2 = other.m_hashTable[i];
             e1.count -= e2.count;
             e1.keySum ^= e2.keySum;
             e1.keyCheck ^= e2.keyCheck;
@@ -276,51 +324,28 @@ class IBLT
         return result;
     }
 
-    std::vector<HashTableEntry> getHashTable() const { return m_hashTable; }
+    const HashTable& getHashTable() const noexcept { return m_hashTable; }
 
     /**
      * @brief Appends self to name
      *
-     * Encodes our hash table from uint32_t vector to uint8_t vector
-     * We create a uin8_t vector 12 times the size of uint32_t vector
-     * We put the first count in first 4 cells, keySum in next 4, and keyCheck
-     * in next 4. Repeat for all the other cells of the hash table. Then we
-     * append this uint8_t vector to the name.
+     * Encodes our hash table as a byte vector unitSize times the number
+     * of cells. Each cell is encoded little-endian as its count (4 bytes),
+     * keySum (sizeof(HashVal) bytes) then keyCheck (4 bytes). The vector
+     * is zlib compressed then appended to the name.
      *
      * @param name
      */
     void appendToName(ndn_ind::Name& name) const
     {
-        size_t n = m_hashTable.size();
-        size_t unitSize = (32 * 3) / 8;  // hard coding
-        size_t tableSize = unitSize * n;
-
-        std::vector<char> table(tableSize);
-
-        for (size_t i = 0; i < n; i++) {
-            // table[i*12],   table[i*12+1], table[i*12+2], table[i*12+3] -->
-            // hashTable[i].count
-
-            table[(i * unitSize)] = 0xFF & m_hashTable[i].count;
-            table[(i * unitSize) + 1] = 0xFF & (m_hashTable[i].count >> 8);
-            table[(i * unitSize) + 2] = 0xFF & (m_hashTable[i].count >> 16);
-            table[(i * unitSize) + 3] = 0xFF & (m_hashTable[i].count >> 24);
-
-            // table[i*12+4], table[i*12+5], table[i*12+6], table[i*12+7] -->
-            // hashTable[i].keySum
-
-            table[(i * unitSize) + 4] = 0xFF & m_hashTable[i].keySum;
-            table[(i * unitSize) + 5] = 0xFF & (m_hashTable[i].keySum >> 8);
-            table[(i * unitSize) + 6] = 0xFF & (m_hashTable[i].keySum >> 16);
-            table[(i * unitSize) + 7] = 0xFF & (m_hashTable[i].keySum >> 24);
-
-            // table[i*12+8], table[i*12+9], table[i*12+10], table[i*12+11] -->
-            // hashTable[i].keyCheck
-
-            table[(i * unitSize) + 8] = 0xFF & m_hashTable[i].keyCheck;
-            table[(i * unitSize) + 9] = 0xFF & (m_hashTable[i].keyCheck >> 8);
-            table[(i * unitSize) + 10] = 0xFF & (m_hashTable[i].keyCheck >> 16);
-            table[(i * unitSize) + 11] = 0xFF & (m_hashTable[i].keyCheck >> 24);
+        std::array<char, N * unitSize> table;
+
+        auto t = (uint8_t*)table.data();
+        for (const auto& entry : m_hashTable) {
+            putLE(t, entry.count);
+            putLE(t + sizeof(int32_t), entry.keySum);
+            putLE(t + sizeof(int32_t) + sizeof(HashVal), entry.keyCheck);
+            t += unitSize;
         }
         bio::filtering_streambuf<bio::input> in;
         in.push(bio::zlib_compressor());
@@ -336,98 +361,83 @@ class IBLT
     /**
      * @brief Extracts IBLT from name component
      *
-     * Converts the name into a uint8_t vector which is then decoded to a
-     * a uint32_t vector.
+     * Decompresses the component value into the byte string of
+     * encoded cells described in appendToName.
      *
      * @param ibltName IBLT represented as a Name Component
-     * @return a uint32_t vector representing the hash table of the IBLT
+     * @return a string holding the encoded hash table of the IBLT
      */
-    std::vector<uint32_t> extractValueFromName(
-        const ndn_ind::Name::Component& ibltName) const
+    static std::string extractValueFromName(const ndn_ind::Name::Component& ibltName)
     {
-        std::string compressed
-          (ibltName.getValue().buf(),
-           ibltName.getValue().buf() + ibltName.getValue().size());
+        const auto& v = ibltName.getValue();
 
         bio::filtering_streambuf<bio::input> in;
         in.push(bio::zlib_decompressor());
-        in.push(bio::array_source(compressed.data(), compressed.size()));
+        in.push(bio::array_source((const char*)v.buf(), v.size()));
 
         std::stringstream sstream;
         bio::copy(in, sstream);
-        std::string ibltStr = sstream.str();
-
-        std::vector<uint8_t> ibltValues(ibltStr.begin(), ibltStr.end());
-        size_t n = ibltValues.size() / 4;
-
-        std::vector<uint32_t> values(n, 0);
-
-        for (size_t i = 0; i < 4 * n; i += 4) {
-            uint32_t t = (ibltValues[i + 3] << 24) + (ibltValues[i + 2] << 16) +
-                         (ibltValues[i + 1] << 8) + ibltValues[i];
-            values[i / 4] = t;
-        }
-        return values;
+        return sstream.str();
     }
 
    private:
-    void update(int plusOrMinus, uint32_t key)
+    template<typename T>
+    static void putLE(uint8_t* b, T v) noexcept
+    {
+        using U = std::make_unsigned_t<T>;
+        for (size_t i = 0; i < sizeof(T); i++) b[i] = 0xFF & (U(v) >> (i * 8));
+    }
+
+    template<typename T>
+    static T getLE(const uint8_t* b) noexcept
     {
-        size_t bucketsPerHash = m_hashTable.size() / N_HASH;
+        std::make_unsigned_t<T> v{};
+        for (size_t i = 0; i < sizeof(T); i++) v |= decltype(v)(b[i]) << (i * 8);
+        return T(v);
+    }
 
-        for (size_t i = 0; i < N_HASH; i++) {
-            size_t startEntry = i * bucketsPerHash;
-            uint32_t h = ndn_ind::CryptoLite::murmurHash3(i, key);
-            HashTableEntry& entry =
-                m_hashTable.at(startEntry + (h % bucketsPerHash));
+    void update(int plusOrMinus, const IBLTKey& k)
+    {
+        for (auto idx : {k.hash0, k.hash1, k.hash2}) {
+            Entry& entry = m_hashTable[idx];
             entry.count += plusOrMinus;
-            entry.keySum ^= key;
-            entry.keyCheck ^= ndn_ind::CryptoLite::murmurHash3(N_HASHCHECK, key);
+            entry.keySum ^= k.key;
+            entry.keyCheck ^= k.check;
         }
     }
 
-    std::vector<HashTableEntry> m_hashTable;
+    HashTable m_hashTable{};
 };
 
-static inline bool operator==(const IBLT& iblt1, const IBLT& iblt2)
+template<size_t N, typename HashVal>
+static inline bool operator==(const IBLT<N, HashVal>& iblt1, const IBLT<N, HashVal>& iblt2)
 {
-    auto iblt1HashTable = iblt1.getHashTable();
-    auto iblt2HashTable = iblt2.getHashTable();
-    if (iblt1HashTable.size() != iblt2HashTable.size()) {
-        return false;
-    }
-
-    size_t N = iblt1HashTable.size();
-
-    for (size_t i = 0; i < N; i++) {
-        if (iblt1HashTable[i].count != iblt2HashTable[i].count ||
-            iblt1HashTable[i].keySum != iblt2HashTable[i].keySum ||
-            iblt1HashTable[i].keyCheck != iblt2HashTable[i].keyCheck)
-            return false;
-    }
-    return true;
+    return iblt1.getHashTable() == iblt2.getHashTable();
 }
 
-static inline bool operator!=(const IBLT& iblt1, const IBLT& iblt2)
+template<size_t N, typename HashVal>
+static inline bool operator!=(const IBLT<N, HashVal>& iblt1, const IBLT<N, HashVal>& iblt2)
 {
     return !(iblt1 == iblt2);
 }
 
-static inline std::ostream& operator<<(std::ostream& out, const HashTableEntry& hte)
+template<typename HashVal>
+static inline std::ostream& operator<<(std::ostream& out, const HashTableEntry<HashVal>& hte)
 {
-    out << std::dec << std::setw(5) << hte.count << std::hex << std::setw(9)
-        << hte.keySum << std::setw(9) << hte.keyCheck;
+    out << std::dec << std::setw(5) << hte.count << std::hex
+        << std::setw(sizeof(HashVal) * 2 + 1) << hte.keySum << std::setw(9) << hte.keyCheck;
     return out;
 }
 
-static inline std::string prtPeer(const IBLT& iblt, size_t idx, size_t rep)
+template<size_t N, typename HashVal>
+static inline std::string prtPeer(const IBLT<N, HashVal>& iblt, size_t idx, size_t rep)
 {
     if (idx == rep) {
         return "";
     }
     std::ostringstream rslt{};
     rslt << " @" << std::hex << rep;
-    auto hte = iblt.getHashTable().at(rep);
+    const auto& hte = iblt.getHashTable().at(rep);
     if (hte.isEmpty()) {
         rslt << "!";
     } else if (iblt.getHashTable().at(idx).keySum != hte.keySum) {
@@ -436,9 +446,10 @@ static inline std::string prtPeer(const IBLT& iblt, size_t idx, size_t rep)
     return rslt.str();
 }
 
-static inline std::string prtPeers(const IBLT& iblt, size_t idx)
+template<size_t N, typename HashVal>
+static inline std::string prtPeers(const IBLT<N, HashVal>& iblt, size_t idx)
 {
-    auto hte = iblt.getHashTable().at(idx);
+    const auto& hte = iblt.getHashTable().at(idx);
     if (! hte.isPure()) {
         // can only get the peers of 'pure' entries
         return "";
@@ -448,7 +459,8 @@ static inline std::string prtPeers(const IBLT& iblt, size_t idx)
            prtPeer(iblt, idx, iblt.hash2(hte.keySum));
 }
 
-static inline std::ostream& operator<<(std::ostream& out, const IBLT& iblt)
+template<size_t N, typename HashVal>
+static inline std::ostream& operator<<(std::ostream& out, const IBLT<N, HashVal>& iblt)
 {
     out << "idx count keySum keyCheck\n";
     auto idx = 0;
@@ -22,6 +22,8 @@
 
 #include <map>
 
+#include <boost/asio/post.hpp>
+
 #include <log4cxx/logger.h>
 
 #include "ndn-cxx-ind.hpp"
@@ -227,6 +229,15 @@ class SyncPubsub
         return m_scheduler.schedule(after, cb);
     }
 
+    /**
+     * @brief run a callback on the event manager's thread as soon as possible
+     *
+     * Can be called from any thread.
+     *
+     * @param cb routine to call
+     */
+    void post(std::function<void()>&& cb) { boost::asio::post(m_face.getIoService(), std::move(cb)); }
+
   private:
 
     uint32_t hashPub(const Publication& pub) const
@@ -249,6 +260,11 @@ class SyncPubsub
     log4cxx::LoggerPtr staticModuleLogger;
 };
 
+// svs always uses dynamically dispatched sigmgrs; this alias lets code
+// written against syncps' SyncPubsubT build with either.
+template<typename WireSM = SigMgr, typename PubSM = SigMgr>
+using SyncPubsubT = SyncPubsub;
+
 }  // namespace syncps
 
 #endif  // SYNCPS_SYNCPS_HPP
@@ -29,8 +29,11 @@
 #include <limits>
 #include <map>
 #include <random>
+#include <span>
 #include <unordered_map>
 
+#include <boost/asio/post.hpp>
+
 #include <ndn-ind/async-face.hpp>
 #include <ndn-ind/security/key-chain.hpp>
 #include <ndn-ind/security/validator-null.hpp>
@@ -39,6 +42,7 @@
 #include <ndn-ind/util/scheduler.hpp>
 
 #include "dct/format.hpp"
+#include "dct/reject_cache.hpp"
 #include "dct/sigmgrs/sigmgr.hpp"
 #include "iblt.hpp"
 
@@ -54,7 +58,8 @@ using Timer = ndn_ind::scheduler::ScopedEventId; // for key-distributors
 
 enum class tlv : uint8_t {
     Data = 6,           // Publication (AKA NDN Data object)
-    syncpsContent = 129 // block of publications
+    syncpsContent = 129,// block of publications
+    compactData = 130   // Publication in a collection-specific compact form
 };
 
 //default values
@@ -64,6 +69,11 @@ static constexpr std::chrono::milliseconds maxPubLifetime = std::chrono::seconds
 static constexpr std::chrono::milliseconds maxClockSkew = std::chrono::seconds(1);
 static constexpr uint32_t maxDifferences = 85u;  // = 128/1.5 (see detail/iblt.hpp)
 
+// Publications are identified by a 64 bit hash of their wire encoding (32 bit
+// hashes collide often enough at high pub rates to cause silent non-delivery).
+using PubHash = uint64_t;
+using SyncIBLT = IBLT<ibltCells(maxDifferences), PubHash>;
+
 /**
  * @brief app callback when new publications arrive
  */
@@ -86,6 +96,21 @@ using GetLifetimeCb = std::function<std::chrono::milliseconds(const Publication&
 using PubPtr = std::shared_ptr<const Publication>;
 using VPubPtr = std::vector<PubPtr>;
 using FilterPubsCb = std::function<VPubPtr(VPubPtr&,VPubPtr&)>;
+/**
+ * @brief app callback to return the 'source' of a publication used to rate
+ *        limit validation failures. It's called with the (validated) sync
+ *        Data that carried the pub and must only depend on things a sender
+ *        can't forge (e.g., a hash of the Data's signer if the wire sigmgr
+ *        authenticates individual senders). It returns 0 if the sender can't
+ *        be identified: failures of those pubs aren't counted and the pubs
+ *        are never shed (only the negative cache applies to them).
+ */
+using PubSourceCb = std::function<uint64_t(const ndn_ind::Data&, const Publication&)>;
+/**
+ * @brief app callbacks to convert a publication's wire format to and from a
+ *        collection-specific compact form. Each returns false if it can't.
+ */
+using PubCodecCb = std::function<bool(std::span<const uint8_t>, std::vector<uint8_t>&)>;
 
 /**
  * @brief sync a lifetime-bounded set of publications among
@@ -102,11 +127,24 @@ using FilterPubsCb = std::function<VPubPtr(VPubPtr&,VPubPtr&)>;
  * is signed so it is protected against replay attacks. App publications
  * are signed by pubCertificate and external publications are verified by
  * pubValidator on arrival.
+ *
+ * SyncPubsubT is parameterized by the types of its wire and publication
+ * sigmgrs. The default (SigMgr) uses virtual dispatch and accepts any sigmgr.
+ * Instantiating with concrete sigmgr types (or SigMgrAny) binds the per-packet
+ * sign/validate calls at compile time via sigmgrPolicy.
+ *
+ * The third parameter is the IBLT type used to summarize the active set. The
+ * default suits ~1KB pubs on a 1460B MTU. Collections of small, frequent pubs
+ * may want more cells (more differences decode per exchange) and ones with few
+ * pubs may want 32 bit keys (a smaller sync interest). All members of a
+ * collection must use the same IBLT type. Pub hashes are the IBLT's key type.
  */
 
-class SyncPubsub
+template<typename WireSM = SigMgr, typename PubSM = SigMgr, typename Iblt = SyncIBLT>
+class SyncPubsubT
 {
   public:
+    using PubHash = typename Iblt::Key;
     using Nonce = std::array<uint8_t,4>; // Interest Nonce format
     struct Error : public std::runtime_error { using std::runtime_error::runtime_error; };
 
@@ -131,14 +169,12 @@ class SyncPubsub
      * @param wsig The sigmgr for Data packet signing and validation
      * @param psig The sigmgr for Publication validation
      */
-    SyncPubsub(Name syncPrefix, SigMgr& wsig, SigMgr& psig) : SyncPubsub(getFace(), syncPrefix, wsig, psig) {}
+    SyncPubsubT(Name syncPrefix, WireSM& wsig, PubSM& psig) : SyncPubsubT(getFace(), syncPrefix, wsig, psig) {}
 
-    SyncPubsub(ndn_ind::AsyncFace& face, Name syncPrefix, SigMgr& wsig, SigMgr& psig)
+    SyncPubsubT(ndn_ind::AsyncFace& face, Name syncPrefix, WireSM& wsig, PubSM& psig)
         : m_face(face),
           m_syncPrefix(std::move(syncPrefix)),
           m_scheduler(m_face.getIoService()),
-          m_iblt(maxDifferences),
-          m_pcbiblt(maxDifferences),
           m_sigmgr(wsig),
           m_pubSigmgr(psig),
           staticModuleLogger{log4cxx::Logger::getLogger(m_syncPrefix.toUri())},
@@ -152,37 +188,58 @@ class SyncPubsub
     /**
      * @brief methods to change the 'isExpired' and/or 'filterPubs' callbacks
      */
-    SyncPubsub& isExpiredCb(IsExpiredCb&& isExpired) {
+    SyncPubsubT& isExpiredCb(IsExpiredCb&& isExpired) {
         m_isExpired = std::move(isExpired);
         return *this;
     }
-    SyncPubsub& filterPubsCb(FilterPubsCb&& filterPubs) {
+    SyncPubsubT& filterPubsCb(FilterPubsCb&& filterPubs) {
         m_filterPubs = std::move(filterPubs);
         return *this;
     }
     /**
      * @brief methods to change various timer values
      */
-    SyncPubsub& syncInterestLifetime(std::chrono::milliseconds time) {
+    SyncPubsubT& syncInterestLifetime(std::chrono::milliseconds time) {
         m_syncInterestLifetime = time;
         return *this;
     }
-    SyncPubsub& syncDataLifetime(std::chrono::milliseconds time) {
+    SyncPubsubT& syncDataLifetime(std::chrono::milliseconds time) {
         m_syncDataLifetime = time;
         return *this;
     }
-    SyncPubsub& pubLifetime(std::chrono::milliseconds time) {
+    SyncPubsubT& pubLifetime(std::chrono::milliseconds time) {
         m_pubLifetime = time;
         return *this;
     }
-    SyncPubsub& pubExpirationGB(std::chrono::milliseconds time) {
+    SyncPubsubT& pubExpirationGB(std::chrono::milliseconds time) {
         m_pubExpirationGB = time > maxClockSkew? time : maxClockSkew;
         return *this;
     }
-    SyncPubsub& badPubCb(UpdateCb cb) {
+    SyncPubsubT& badPubCb(UpdateCb cb) {
         m_badPubCb = cb;
         return *this;
     }
+    SyncPubsubT& pubSourceCb(PubSourceCb&& pubSource) {
+        m_pubSource = std::move(pubSource);
+        return *this;
+    }
+    /**
+     * @brief methods to set how pubs are compacted when sent and expanded on
+     *        arrival. Arriving compact pubs are dropped if there's no expander.
+     */
+    SyncPubsubT& compactPubCb(PubCodecCb&& compact) {
+        m_compactPub = std::move(compact);
+        return *this;
+    }
+    SyncPubsubT& expandPubCb(PubCodecCb&& expand) {
+        m_expandPub = std::move(expand);
+        return *this;
+    }
+    /**
+     * @brief bad pub negative cache and failure rate limiter (for stats & tuning)
+     */
+    auto& rejects() { return m_rejects; }
+    auto& failLimit() { return m_failLimit; }
 
 
     /**
@@ -194,16 +251,29 @@ class SyncPubsub
      *
      * @param pub the object to publish
      */
-    uint32_t publish(Publication&& pub)
+    PubHash publish(Publication&& pub) { return publish(std::move(pub), PublishCb{}); }
+
+    /**
+     * @brief handle a new publication from app
+     *
+     * A publication is published at most once and
+     * lives for at most pubLifetime. This version
+     * takes a callback so publication can be confirmed
+     * or failure reported so "at least once" or other
+     * semantics can be built into shim. Sets callback.
+     *
+     * @param pub the object to publish
+     */
+    PubHash publish(Publication&& pub, PublishCb&& cb)
     {
-        if (isKnown(pub)) {
+        auto h = hashPub(pub);
+        if (isKnown(h)) {
             _LOG_INFO("republish of '" << pub.getName() << "' ignored");
             return 0;
         }
         _LOG_INFO("Publish: " << pub.getName());
         ++m_publications;
-        auto h = hashPub(pub);
-        addToActive(std::move(pub), true);
+        addToActive(std::move(pub), h, true, std::move(cb));
         // new pub may let us respond to pending interest(s).
         if (! m_delivering) {
             sendSyncInterest();
@@ -211,26 +281,31 @@ class SyncPubsub
         }
         return h;
     }
+
     /**
-     * @brief handle a new publication from app
+     * @brief forget a publication received from a peer
      *
-     * A publication is published at most once and
-     * lives for at most pubLifetime. This version
-     * takes a callback so publication can be confirmed
-     * or failure reported so "at least once" or other
-     * semantics can be built into shim. Sets callback.
+     * Removes the pub from the active set and the iblt so it will be
+     * fetched again if a peer still has it. This is for subscribers that
+     * couldn't use a pub when it arrived and had to drop it (e.g., a cert
+     * evicted from a bounded store while waiting for its signer). Only
+     * collections whose pubs don't expire can use this since expiring pubs
+     * have scheduled iblt removals. Returns true if the pub was forgotten.
      *
-     * @param pub the object to publish
+     * @param pub the publication to forget
      */
-    uint32_t publish(Publication&& pub, PublishCb&& cb)
+    bool forget(const Publication& pub)
     {
-        auto h = publish(std::move(pub));
-        if (h != 0) {
-            //using returned hash of signed pub
-            m_pubCbs[h] = std::move(cb);
-            m_pcbiblt.insert(h);
-        }
-        return h;
+        if (m_pubLifetime != decltype(m_pubLifetime)::zero()) return false;
+        const auto hash = hashPub(pub);
+        const auto h = m_hash2pub.find(hash);
+        if (h == m_hash2pub.end()) return false;
+        const auto p = h->second;
+        if (const auto a = m_active.find(p); a != m_active.end() && (a->second & 2) != 0) return false; // ours
+        _LOG_DEBUG("forget: " << p->getName());
+        m_iblt.erase(Iblt::makeKey(hash));
+        removeFromActive(p, hash);
+        return true;
     }
 
     /**
@@ -241,7 +316,7 @@ class SyncPubsub
      *
      * @param  topic the topic
      */
-    SyncPubsub& subscribeTo(const Name& topic, UpdateCb&& cb)
+    SyncPubsubT& subscribeTo(const Name& topic, UpdateCb&& cb)
     {
         // add to subscription dispatch table. If subscription is new,
         // 'cb' will be called with each matching item in the active
@@ -269,7 +344,7 @@ class SyncPubsub
      *
      * @param  topic the topic
      */
-    SyncPubsub& unsubscribe(const Name& topic)
+    SyncPubsubT& unsubscribe(const Name& topic)
     {
         _LOG_INFO("unsubscribe: " << topic);
         m_subscription.erase(topic);
@@ -298,6 +373,16 @@ class SyncPubsub
         return m_scheduler.schedule(after, cb);
     }
 
+    /**
+     * @brief run a callback on the event manager's thread as soon as possible
+     *
+     * Unlike the other methods, this can be called from any thread (e.g.,
+     * to hand the results of work done on another thread back to syncps).
+     *
+     * @param cb routine to call
+     */
+    void post(std::function<void()>&& cb) { boost::asio::post(m_face.getIoService(), std::move(cb)); }
+
     /**
      * Get the publication from the active set by exact name match.
      * @param name The name of the publication to search for.
@@ -358,7 +443,7 @@ class SyncPubsub
                     fmt::join(m_syncPrefix,"/")));
         m_face.expressInterest(syncInterest,
                 [this](auto& i, auto& d) {
-                    if (! m_sigmgr.validateDecrypt(*d)) {
+                    if (! sigmgrPolicy<WireSM>::validateDecrypt(m_sigmgr, *d)) {
                         _LOG_DEBUG("can't validate: " << d->getName());
                         // if data consumed our current interest refresh it soon
                         // but not immediately since if we get the same Data back
@@ -426,15 +511,15 @@ class SyncPubsub
         // two sets:
         //   have - (hashes of) items we have that they don't
         //   need - (hashes of) items we need that they have
-        IBLT iblt(maxDifferences);
+        Iblt iblt{};
         try {
             iblt.initialize(name.get(-1));
         } catch (const std::exception& e) {
             _LOG_WARN(e.what());
             return true;
         }
-        std::set<uint32_t> have;
-        std::set<uint32_t> need;
+        std::set<PubHash> have;
+        std::set<PubHash> need;
         if(m_pubCbs.size()) {
             // some publications have delivery callbacks so see if any
             // are in this iblt (they'll be in the 'need' set).
@@ -450,7 +535,7 @@ class SyncPubsub
                 //published here and has cb - do the cb then erase it
                 m_pubCbs[hash](*h->second, true);
                 m_pubCbs.erase(hash);
-                m_pcbiblt.erase(hash);
+                m_pcbiblt.erase(Iblt::makeKey(hash));
             }
             have.clear();
             need.clear();
@@ -478,21 +563,43 @@ class SyncPubsub
         if (pOurs.empty()) return false;
 
         // send all the pubs that will fit in a data packet, always sending at least one.
-        for (size_t pubsSize = 0, i = 0; i < pOurs.size(); ++i) {
+        std::vector<uint8_t> c{};
+        for (size_t i = 0; i < pOurs.size(); ++i) {
             _LOG_DEBUG("Send pub " << pOurs[i]->getName());
-            auto encoding = pOurs[i]->wireEncode();
-            pubsSize += encoding.size();
-            if (pubsSize >= maxPubSize) {
+            const auto sz = c.size();
+            appendPub(c, *pOurs[i]);
+            if (c.size() >= maxPubSize) {
                 // if we're over and there's more than one piece leave the last
-                if (pubsSize > maxPubSize && i > 0) --i;
-                pOurs.resize(i + 1);
+                if (c.size() > maxPubSize && i > 0) c.resize(sz);
                 break;
             }
         }
-        sendSyncData(name, pOurs);
+        sendSyncData(name, c);
         return true;
     }
 
+    // append pub 'p' to sync data content 'c' (in compact form if possible)
+    void appendPub(std::vector<uint8_t>& c, const Publication& p) const
+    {
+        const auto& wf = *p.wireEncode();
+        if (m_compactPub) {
+            std::vector<uint8_t> cp{};
+            if (m_compactPub(wf, cp)) {
+                c.emplace_back(uint8_t(tlv::compactData));
+                if (cp.size() < 253) {
+                    c.emplace_back(cp.size());
+                } else {
+                    c.emplace_back(253);
+                    c.emplace_back(cp.size() >> 8);
+                    c.emplace_back(cp.size());
+                }
+                c.insert(c.end(), cp.begin(), cp.end());
+                return;
+            }
+        }
+        c.insert(c.end(), wf.begin(), wf.end());
+    }
+
     /**
      * @brief Send a sync data packet responding to a sync interest.
      *
@@ -501,27 +608,17 @@ class SyncPubsub
      *
      * @param name  is the name from the sync interest we're responding to
      *              (data packet's base name)
-     * @param pubs  vector of publications (data packet's payload)
+     * @param pubs  the concatenated publications (data packet's payload)
      */
-    void sendSyncData(const ndn_ind::Name& name, const VPubPtr& pubs)
+    void sendSyncData(const ndn_ind::Name& name, const std::vector<uint8_t>& pubs)
     {
         _LOG_DEBUG(format(fmt::runtime("sendSyncData {:x} {}"), hashIBLT(name), name.toUri()));
         ndn_ind::Data data(name);
         // data only useful until iblt changes so limit freshness
         data.getMetaInfo().setFreshnessPeriod(m_syncDataLifetime);
         //data.getMetaInfo().setType(tlv::syncpsContent);
-        if (pubs.size() > 1) {
-            // have to concatenate the pubs
-            std::vector<uint8_t> c{};
-            for (const auto& p : pubs) {
-                auto v = *(p->wireEncode());
-                c.insert(c.end(), v.begin(), v.end());
-            }
-            data.setContent(c);
-        } else {
-            data.setContent(pubs[0]->wireEncode());
-        }
-        if(! m_sigmgr.sign(data)) {
+        data.setContent(pubs);
+        if(! sigmgrPolicy<WireSM>::sign(m_sigmgr, data)) {
             _LOG_WARN("sendSyncData: failed to sign " << name);
             return;
         }
@@ -530,12 +627,15 @@ class SyncPubsub
 
     auto parsePubs(const std::vector<uint8_t>& dat, tlv expected) const {
         PubVec pubs{};
+        std::vector<uint8_t> wf{};      // expanded compact pub
         auto pp = dat.data();
         auto ep = dat.data() + dat.size();
         // minimum Data size is at least 8 bytes
         while (pp < ep - 8) {
             auto bp = pp;
-            if ((tlv)*bp++ != expected) {
+            const auto t = (tlv)*bp++;
+            const bool compact = t == tlv::compactData && m_expandPub;
+            if (t != expected && ! compact) {
                 _LOG_WARN("unexpected tlv in pub content");
                 return PubVec();
             }
@@ -552,12 +652,19 @@ class SyncPubsub
                 _LOG_WARN("pub bigger than content");
                 return PubVec();
             }
-            // Data length includes tlv bytes
-            len += bp - pp;
             Publication pub{};
-            pub.wireDecode(pp, len);
+            if (compact) {
+                if (! m_expandPub({bp, len}, wf)) {
+                    _LOG_WARN("can't expand compact pub");
+                    return PubVec();
+                }
+                pub.wireDecode(wf.data(), wf.size());
+            } else {
+                // Data length includes tlv bytes
+                pub.wireDecode(pp, len + (bp - pp));
+            }
             pubs.emplace_back(pub);
-            pp += len;
+            pp = bp + len;
         }
         if (pp != ep) {
             _LOG_WARN("extra data in pub content");
@@ -587,14 +694,32 @@ class SyncPubsub
         auto initpubs = m_publications;
 
         for (auto& pub : parsePubs(*data.getContent(), tlv::Data)) {
-            if (isKnown(pub)) {
+            auto hash = hashPub(pub);
+            if (isKnown(hash)) {
                 _LOG_DEBUG("ignore known " << pub.getName());
                 continue;
             }
-            if (m_isExpired(pub) || ! m_pubSigmgr.validate(pub)) {
+            if (m_rejects.contains(hash)) {
+                // already failed validation - skip the crypto
+                ignorePub(pub, hash);
+                continue;
+            }
+            if (m_isExpired(pub)) {
                 // unwanted pubs have to go in our iblt or we'll keep getting them
                 m_badPubCb(pub);
-                ignorePub(pub);
+                ignorePub(pub, hash);
+                continue;
+            }
+            // if pubs from this (authenticated) source have been failing at a
+            // high rate, don't spend time validating its pubs (good ones will
+            // be resent later)
+            const auto src = m_pubSource(data, pub);
+            if (src && m_failLimit.shedding(src)) continue;
+            if (! sigmgrPolicy<PubSM>::validate(m_pubSigmgr, pub)) {
+                m_rejects.add(hash);
+                if (src) m_failLimit.fail(src);
+                m_badPubCb(pub);
+                ignorePub(pub, hash);
                 continue;
             }
 
@@ -606,7 +731,7 @@ class SyncPubsub
             // Also, it would be faster to do the comparison on the
             // wire-format names (excluding the leading length value)
             // rather than default of component-by-component.
-            const auto& p = addToActive(std::move(pub));
+            const auto& p = addToActive(std::move(pub), hash);
             const auto& nm = p->getName();
             auto sub = m_subscription.lower_bound(nm);
             if ((sub != m_subscription.end() && sub->first.isPrefixOf(nm)) ||
@@ -635,13 +760,18 @@ class SyncPubsub
     // publications are stored using a shared_ptr so we
     // get to them indirectly via their hash.
 
-    uint32_t hashPub(const Publication& pub) const
+    PubHash hashPub(const Publication& pub) const
     {
         const auto& b = *pub.wireEncode();
-        return ndn_ind::CryptoLite::murmurHash3(N_HASHCHECK, b.data(), b.size());
+        const auto h = ndn_ind::CryptoLite::murmurHash3(N_HASHCHECK, b.data(), b.size());
+        if constexpr (sizeof(PubHash) <= sizeof(uint32_t)) {
+            return h;
+        } else {
+            return PubHash(h) << 32 | ndn_ind::CryptoLite::murmurHash3(N_HASHCHECK + 1, b.data(), b.size());
+        }
     }
 
-    bool isKnown(uint32_t h) const
+    bool isKnown(PubHash h) const
     {
         //return m_hash2pub.contains(h);
         return m_hash2pub.find(h) != m_hash2pub.end();
@@ -654,14 +784,21 @@ class SyncPubsub
         return isKnown(hashPub(pub));
     }
 
-    std::shared_ptr<Publication> addToActive(Publication&& pub, bool localPub = false)
+    // 'hash' is the pub's hashPub(). Its iblt key is computed once here and
+    // reused for every iblt insert & erase of the pub.
+    std::shared_ptr<Publication> addToActive(Publication&& pub, PubHash hash, bool localPub = false,
+                                             PublishCb&& cb = {})
     {
         _LOG_DEBUG("addToActive: " << pub.getName());
-        auto hash = hashPub(pub);
-        auto p = std::make_shared<Publication>(pub);
+        const auto key = Iblt::makeKey(hash);
+        auto p = std::make_shared<Publication>(std::move(pub));
         m_active[p] = localPub? 3 : 1;
         m_hash2pub[hash] = p;
-        m_iblt.insert(hash);
+        m_iblt.insert(key);
+        if (cb) {
+            m_pubCbs[hash] = std::move(cb);
+            m_pcbiblt.insert(key);
+        }
 
         // We remove an expired publication from our active set at twice its pub
         // lifetime (the extra time is to prevent replay attacks enabled by clock
@@ -676,15 +813,15 @@ class SyncPubsub
         auto pubLifetime = m_pubLifetime; //in case becomes a function of *p
         if (pubLifetime == decltype(pubLifetime)::zero()) return p; // pubs don't expire in this collection
 
-        m_scheduler.schedule(pubLifetime, [this, p, hash] {
+        m_scheduler.schedule(pubLifetime, [this, p, key] {
                                                 m_active[p] &=~ 1U;
-                                                if(m_pubCbs.contains(hash)) {
-                                                    m_pubCbs[hash](*p, false);
-                                                    m_pubCbs.erase(hash);
-                                                    m_pcbiblt.erase(hash);
+                                                if(m_pubCbs.contains(key.key)) {
+                                                    m_pubCbs[key.key](*p, false);
+                                                    m_pubCbs.erase(key.key);
+                                                    m_pcbiblt.erase(key);
                                                 } });
-        m_scheduler.schedule(pubLifetime + maxClockSkew, [this, hash] { m_iblt.erase(hash); });
-        m_scheduler.schedule(pubLifetime + m_pubExpirationGB, [this, p] { removeFromActive(p); });
+        m_scheduler.schedule(pubLifetime + maxClockSkew, [this, key] { m_iblt.erase(key); });
+        m_scheduler.schedule(pubLifetime + m_pubExpirationGB, [this, p, hash] { removeFromActive(p, hash); });
 
         return p;
     }
@@ -692,18 +829,18 @@ class SyncPubsub
     /*
      * @brief ignore a publication by temporarily adding it to the our iblt
      */
-    void ignorePub(const Publication& pub) {
+    void ignorePub(const Publication& pub, PubHash hash) {
         _LOG_DEBUG("ignorePub: " << pub.getName());
-        auto hash = hashPub(pub);
-        m_iblt.insert(hash);
-        m_scheduler.schedule(m_pubLifetime + maxClockSkew, [this, hash] { m_iblt.erase(hash); });
+        const auto key = Iblt::makeKey(hash);
+        m_iblt.insert(key);
+        m_scheduler.schedule(m_pubLifetime + maxClockSkew, [this, key] { m_iblt.erase(key); });
     }
 
-    void removeFromActive(const PubPtr& p)
+    void removeFromActive(const PubPtr& p, PubHash hash)
     {
         _LOG_DEBUG("removeFromActive: " << p->getName());
         m_active.erase(p);
-        m_hash2pub.erase(hashPub(*p));
+        m_hash2pub.erase(hash);
     }
 
     /**
@@ -728,15 +865,15 @@ class SyncPubsub
     ndn_ind::Name m_syncPrefix;
     ndn_ind::scheduler::Scheduler m_scheduler;
     std::pair<ndn_ind::Name,std::chrono::system_clock::time_point> m_interest{};
-    IBLT m_iblt;
-    IBLT m_pcbiblt;
+    Iblt m_iblt{};
+    Iblt m_pcbiblt{};
     // currently active published items
     std::unordered_map<std::shared_ptr<const Publication>, uint8_t> m_active{};
-    std::unordered_map<uint32_t, std::shared_ptr<const Publication>> m_hash2pub{};
+    std::unordered_map<PubHash, std::shared_ptr<const Publication>> m_hash2pub{};
     std::map<const Name, UpdateCb> m_subscription{};
-    std::unordered_map <uint32_t, PublishCb> m_pubCbs;
-    SigMgr& m_sigmgr;               // SyncData packet signing and validation
-    SigMgr& m_pubSigmgr;            // Publication validation
+    std::unordered_map <PubHash, PublishCb> m_pubCbs;
+    WireSM& m_sigmgr;               // SyncData packet signing and validation
+    PubSM& m_pubSigmgr;             // Publication validation
     std::chrono::milliseconds m_syncInterestLifetime{std::chrono::milliseconds(557)};
     std::chrono::milliseconds m_syncDataLifetime{std::chrono::seconds(3)};
     std::chrono::milliseconds m_pubLifetime{maxPubLifetime};
@@ -766,8 +903,17 @@ class SyncPubsub
     UpdateCb m_badPubCb{
         [](auto p) {_LOG_WARN("Received bad Publication");}
     };
+    PubSourceCb m_pubSource{
+        // by default senders aren't identified so nothing is shed
+        [](const auto&, const auto&) { return uint64_t(0); } };
+    rejectCache m_rejects{};        // hashes of pubs that failed validation
+    PubCodecCb m_compactPub{};      // convert pubs to compact form for sending (if set)
+    PubCodecCb m_expandPub{};       // convert arriving compact pubs to wire format (if set)
+    failLimiter m_failLimit{};      // per-source validation failure rate limit
 };
 
+using SyncPubsub = SyncPubsubT<>;
+
 }  // namespace syncps
 
 #endif  // SYNCPS_SYNCPS_HPP
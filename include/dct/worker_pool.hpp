@@ -0,0 +1,100 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+/*
+ * workerPool - a fixed set of threads that run queued jobs
+ *
+ * Copyright (C) 2021 Pollere, Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, see <https://www.gnu.org/licenses/>.
+ *  You may contact Pollere, Inc at info@pollere.net.
+ *
+ *  The DCT proof-of-concept is not intended as production code.
+ *  More information on DCT is available from info@pollere.net
+ */
+
+/*
+ * Used to move CPU-heavy work (e.g., signing publications) off the
+ * io thread. Jobs are started in the order posted but may finish in
+ * any order so a job that needs to deliver results in order has to
+ * arrange that itself (see DCTmodel::pubAsync). Jobs must not throw.
+ * Jobs still queued when the pool is destroyed are discarded; running
+ * jobs are waited for.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct workerPool {
+    using Job = std::function<void()>;
+
+    std::mutex mtx_{};
+    std::condition_variable cv_{};
+    std::deque<Job> jobs_{};
+    std::vector<std::jthread> workers_{};
+    bool stop_{false};
+
+    // by default leave one core for the io thread
+    static size_t defaultSize() noexcept {
+        auto n = std::thread::hardware_concurrency();
+        return n > 1? n - 1 : 1;
+    }
+
+    explicit workerPool(size_t n = defaultSize()) {
+        for (n = std::max(n, size_t(1)); n > 0; --n) workers_.emplace_back([this] { work(); });
+    }
+    workerPool(const workerPool&) = delete;
+    workerPool& operator=(const workerPool&) = delete;
+
+    ~workerPool() {
+        {
+            std::lock_guard lck(mtx_);
+            stop_ = true;
+            jobs_.clear();
+        }
+        cv_.notify_all();
+        // jthread destructors join the workers
+    }
+
+    void post(Job&& job) {
+        {
+            std::lock_guard lck(mtx_);
+            jobs_.emplace_back(std::move(job));
+        }
+        cv_.notify_one();
+    }
+
+    auto size() const noexcept { return workers_.size(); }
+
+  private:
+    void work() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lck(mtx_);
+                cv_.wait(lck, [this] { return stop_ || ! jobs_.empty(); });
+                if (stop_) return;
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+#endif // WORKER_POOL_HPP
@@ -46,8 +46,7 @@ int main(int argc, const char* argv[]) {
     }
     try {
         auto buf = fileToVec(*ap++);
-        std::istringstream ss(std::string((char*)buf.data(), buf.size()), std::ios::binary);
-        rdSchema rs(ss);
+        rdSchema rs{std::vector<uint8_t>(buf)};
         auto bs = rs.read();
 
         // schema must be signed the same way as its pubs
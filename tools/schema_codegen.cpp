@@ -0,0 +1,279 @@
+/*
+ * schema_codegen [-n namespace] [-o file] bschema - generate C++ tables for a binary schema
+ *
+ * Writes a header containing constexpr copies of the schema's token,
+ * template, discriminator and pub tables, the schema's SHA-256 digest and,
+ * for each pub, a struct with the name component index of each of its tags
+ * and a matcher for the parts of its templates known at build time (name
+ * length, literal components and discriminator values). Template components
+ * that correspond to cert components depend on the signer's chain so they
+ * (and the full validation) are left to the schema interpreter.
+ *
+ * The pub the model builds (the schema's first pub) also gets a 'prefilter(model)'
+ * function that, if the model's schemaDigest() matches the embedded digest,
+ * installs the pub's matcher in the model so arriving pubs whose names can't
+ * be valid are dropped before their signature is checked.
+ *
+ * Copyright (C) 2021 Pollere, Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, see <https://www.gnu.org/licenses/>.
+ *  You may contact Pollere, Inc at info@pollere.net.
+ *
+ *  The DCT proof-of-concept is not intended as production code.
+ *  More information on DCT is available from info@pollere.net
+ */
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <ranges>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+extern "C" {
+#include <sodium.h>
+}
+#include "dct/format.hpp"
+#include "dct/schema/rdschema.hpp"
+
+void usage(const char** argv) {
+    print("- usage: {} [-n namespace] [-o file] bschema\n", argv[0]);
+    exit(1);
+}
+
+// make 's' a legal C++ identifier (the leading '#' of a schema pub name is dropped)
+static std::string ident(std::string_view s) {
+    if (s.starts_with('#')) s.remove_prefix(1);
+    static const std::set<std::string_view> reserved{ "auto", "bool", "break", "case", "char",
+        "class", "const", "default", "delete", "do", "double", "else", "enum", "float", "for",
+        "if", "int", "long", "namespace", "new", "operator", "private", "public", "return",
+        "short", "signed", "static", "struct", "switch", "template", "this", "typename",
+        "union", "unsigned", "using", "virtual", "void", "while", "name", "tags", "idx" };
+    std::string res{};
+    for (auto c : s) res += std::isalnum((unsigned char)c)? c : '_';
+    if (res.empty() || std::isdigit((unsigned char)res[0])) res.insert(0, "_");
+    if (reserved.contains(res)) res += '_';
+    return res;
+}
+
+// 's' as a C++ string literal (octal escapes since hex escapes are greedy)
+static std::string literal(std::string_view s) {
+    std::string res{"\""};
+    for (auto c : s) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+            res += c;
+        } else if (std::isprint((unsigned char)c)) {
+            res += c;
+        } else {
+            res += format("\\{:03o}", (unsigned char)c);
+        }
+    }
+    return res + '"';
+}
+
+// 'fmt1' applied to each item of 'v' joined by 'sep'
+template<typename T>
+static std::string list(const T& v, auto&& fmt1, std::string_view sep = ", ") {
+    std::string res{};
+    for (const auto& i : v) {
+        if (! res.empty()) res += sep;
+        res += fmt1(i);
+    }
+    return res;
+}
+
+struct codegen {
+    const bSchema& bs_;
+    std::string_view file_;
+    std::string ns_;
+    std::string out_{};
+
+    codegen(const bSchema& bs, std::string_view file, std::string ns) : bs_{bs}, file_{file}, ns_{std::move(ns)} { }
+
+    template <typename... T>
+    void emit(fmt::format_string<T...> format_str, T&&... args) {
+        out_ += format(format_str, std::forward<T>(args)...);
+    }
+
+    void tables() {
+        std::array<uint8_t,crypto_hash_sha256_BYTES> d{};
+        crypto_hash_sha256(d.data(), bs_.buf_->data(), bs_.buf_->size());
+        emit("// SHA-256 of the binary schema (DCTmodel::schemaDigest())\n");
+        emit("inline constexpr std::array<uint8_t,{}> digest{{\n    {} }};\n\n", d.size(),
+             list(d, [](auto b){ return format("0x{:02x}", b); }));
+
+        emit("inline constexpr std::array<std::string_view,{}> tok{{\n", bs_.tok_.size());
+        for (size_t t = 0; t < bs_.tok_.size(); ++t) emit("    {}, // {}\n", literal(bs_.tok_[t]), t);
+        emit("}};\n\n");
+
+        for (size_t t = 0; t < bs_.tmplt_.size(); ++t) {
+            emit("inline constexpr std::array<bComp,{}> tmplt{}{{ {} }}; // {}\n", bs_.tmplt_[t].size(), t,
+                 list(bs_.tmplt_[t], [](auto c){ return format("0x{:02x}", c); }), bs_.bNameToStr(bs_.tmplt_[t]));
+        }
+        emit("inline constexpr std::array<std::span<const bComp>,{}> tmplt{{ {} }};\n\n", bs_.tmplt_.size(),
+             list(std::views::iota(size_t(0), bs_.tmplt_.size()), [](auto t){ return format("tmplt{}", t); }));
+
+        emit("// (chainBM, template, discriminator component, value list, cor)\n");
+        emit("inline constexpr std::array<tDiscrim,{}> discrim{{{{\n", bs_.discrim_.size());
+        for (auto d : bs_.discrim_) emit("    {{ {}, {}, {}, {}, {} }},\n", d.cbm, d.tmpl, d.disc, d.vl, d.cor);
+        emit("}}}};\n\n");
+
+        emit("// (parameter bitmap, discrim bitmap, pub name token, tag list)\n");
+        emit("inline constexpr std::array<tPub,{}> pub{{{{\n", bs_.pub_.size());
+        for (auto p : bs_.pub_) emit("    {{ 0x{:x}, 0x{:x}, {}, {} }},\n", p.par, p.d, p.pub, p.tag);
+        emit("}}}};\n\n");
+    }
+
+    // The chain-independent part of a pub template: its components (literals
+    // are matched, anything else isn't) and, if it has one, its discriminator
+    // component and value set. Discrims with the same template and component
+    // (e.g., for different signing chains) are merged like pubBldr does.
+    struct skel {
+        size_t tmpl;
+        compidx disc;
+        std::set<bComp> vals{};
+    };
+    std::vector<skel> skeletons(const tPub& p) const {
+        std::vector<skel> res{};
+        for (size_t d = 0; d < bs_.discrim_.size(); ++d) {
+            if ((p.d & (discBM(1) << d)) == 0) continue;
+            const auto dc = bs_.discrim_[d];
+            std::set<bComp> vals{};
+            if (dc.vl < maxTok) vals.emplace(dc.vl);
+            else for (auto v : bs_.vlist_[dc.vl & 0x7f]) vals.emplace(v);
+            auto s = std::find_if(res.begin(), res.end(), [&dc](const auto& s){ return s.tmpl == dc.tmpl && s.disc == dc.disc; });
+            if (s == res.end()) res.emplace_back(skel{dc.tmpl, dc.disc, std::move(vals)});
+            else s->vals.insert(vals.begin(), vals.end());
+        }
+        return res;
+    }
+
+    void pubStruct(pubidx pi) {
+        const auto p = bs_.pub_[pi];
+        const auto& tags = bs_.tag_[p.tag];
+        const auto pname = bs_.tok_[p.pub];
+        std::vector<std::string> tagId{};
+        for (auto t : tags) tagId.emplace_back(ident(bs_.tok_[t]));
+
+        emit("// pub {}\n", pname);
+        emit("struct {} {{\n", ident(pname));
+        emit("    static constexpr std::string_view name{{{}}};\n", literal(pname));
+        emit("    static constexpr std::array<std::string_view,{}> tags{{ {} }};\n", tags.size(),
+             list(tags, [this](auto t){ return literal(bs_.tok_[t]); }));
+        emit("    // name component index of each tag\n    struct idx {{\n");
+        for (size_t i = 0; i < tags.size(); ++i) emit("        static constexpr compidx {}{{{}}};\n", tagId[i], i);
+        emit("    }};\n\n");
+
+        // group the templates by length so the matcher switches on it
+        std::map<size_t,std::vector<skel>> byLen{};
+        for (auto& s : skeletons(p)) byLen[bs_.tmplt_[s.tmpl].size()].emplace_back(std::move(s));
+
+        emit("    // false if 'n' can't be a valid name for this pub (true doesn't mean it is:\n"
+             "    // the template components that depend on the signer's chain aren't checked)\n");
+        emit("    template<typename Name>\n    static bool matches(const Name& n) noexcept {{\n");
+        emit("        auto eq = [&n](size_t c, std::string_view s) {{\n"
+             "                const auto& v = n[c].getValue();\n"
+             "                return std::string_view((const char*)v.buf(), v.size()) == s; }};\n");
+        emit("        switch (n.size()) {{\n");
+        for (const auto& [len, sks] : byLen) {
+            emit("        case {}:\n", len);
+            for (const auto& s : sks) {
+                std::vector<std::string> conds{};
+                const auto& tm = bs_.tmplt_[s.tmpl];
+                for (size_t c = 0; c < tm.size(); ++c) {
+                    if (isLit(tm[c])) conds.emplace_back(format("eq({}, {})", c, literal(bs_.tok_[tm[c]])));
+                }
+                // a value set without any token other than 0 means the template isn't
+                // discriminated (see pubValidator::discriminated)
+                const bool discriminated = std::any_of(s.vals.begin(), s.vals.end(), [](auto v){ return v != 0; });
+                if (discriminated && s.disc < tm.size()) {
+                    conds.emplace_back("(" + list(s.vals, [this, &s](auto v){
+                                                return format("eq({}, {})", s.disc, literal(bs_.tok_[v])); }, " || ") + ")");
+                }
+                std::string cond{};
+                for (const auto& c : conds) cond += (cond.empty()? "" : " &&\n                ") + c;
+                emit("            // {}\n", bs_.bNameToStr(tm));
+                emit("            if ({}) return true;\n", cond.empty()? "true" : cond);
+            }
+            emit("            return false;\n");
+        }
+        emit("        default:\n            return false;\n        }}\n    }}\n");
+
+        if (pi == 0) {
+            emit("\n    // if 'm' is running the schema this was generated from, have it drop arriving pubs\n"
+                 "    // that fail matches() before checking their signature. Returns true if it did.\n");
+            emit("    template<typename Model>\n    static bool prefilter(Model& m) {{\n");
+            emit("        if (! std::equal(digest.begin(), digest.end(), m.schemaDigest().begin(), m.schemaDigest().end()))\n"
+                 "            return false;\n");
+            emit("        typename Model::pubFilter f = &matches;\n");
+            emit("        m.pubPrefilter(f);\n        return true;\n    }}\n");
+        }
+        emit("}};\n\n");
+    }
+
+    std::string operator()() {
+        auto guard = ident(ns_);
+        std::transform(guard.begin(), guard.end(), guard.begin(), [](auto c){ return std::toupper(c); });
+        guard += "_HPP";
+        emit("#ifndef {0}\n#define {0}\n", guard);
+        emit("// Generated by schema_codegen from {} - do not edit.\n\n", file_);
+        emit("#include <algorithm>\n#include <array>\n#include <cstdint>\n#include <span>\n#include <string_view>\n"
+             "#include \"dct/schema/bschema.hpp\"\n\n");
+        emit("namespace {} {{\nusing namespace bschema;\n\n", ns_);
+        tables();
+        for (pubidx p = 0; p < bs_.pub_.size(); ++p) pubStruct(p);
+        emit("}} // namespace {}\n\n#endif // {}\n", ns_, guard);
+        return out_;
+    }
+};
+
+int main(int argc, const char* argv[]) {
+    std::string ns{};
+    std::string ofile{};
+
+    const char** ap = argv + 1;
+    const char** ape = argv + argc;
+    for (; ap < ape && (*ap)[0] == '-'; ++ap) {
+        std::string_view a(*ap);
+        if (ap + 1 >= ape) usage(argv);
+        if (a == "-n") ns = *++ap;
+        else if (a == "-o") ofile = *++ap;
+        else usage(argv);
+    }
+    if (ape - ap != 1) usage(argv);
+    const char* sfile = *ap;
+
+    try {
+        std::ifstream is(sfile, std::ios::binary);
+        if (! is) throw schema_error(format("can't open {}", sfile));
+        rdSchema rs(is);
+        bSchema bs{rs.read()};
+        if (bs.pub_.size() == 0) throw schema_error("schema has no pubs");
+        if (ns.empty()) ns = ident(bs.pubName(0)) + "_schema";
+
+        auto out = codegen(bs, sfile, ns)();
+        if (ofile.empty()) {
+            std::cout << out;
+        } else {
+            std::ofstream os(ofile, std::ios::binary);
+            os << out;
+            if (! os) throw schema_error(format("couldn't write {}", ofile));
+        }
+    } catch (const std::runtime_error& se) {
+        print(stderr, "schema error: {}\n", se.what());
+        exit(1);
+    }
+    exit(0);
+}